@@ -0,0 +1,41 @@
+#include "arena.h"
+
+Arena::Arena(size_t block_size) {
+	this->block_size = block_size;
+	current = nullptr;
+	remaining = 0;
+	used = 0;
+	reserved = 0;
+}
+
+void Arena::add_block(size_t size) {
+	blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+	current = blocks.back().get();
+	remaining = size;
+	reserved += size;
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+	size_t padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+
+	if (current == nullptr || padding + size > remaining) {
+		// oversized requests get a block of their own
+		add_block(size + alignment > block_size ? size + alignment : block_size);
+		padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+	}
+
+	char* result = current + padding;
+	current = result + size;
+	remaining -= padding + size;
+	used += size;
+
+	return result;
+}
+
+size_t Arena::bytes_used() const {
+	return used;
+}
+
+size_t Arena::bytes_reserved() const {
+	return reserved;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// bump allocator, everything allocated from it is released together when it is destroyed
+// destructors of the objects are never run, so they must not own memory outside the arena
+class Arena {
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char* current;
+	size_t remaining;
+	size_t block_size;
+	size_t used;
+	size_t reserved;
+
+	void add_block(size_t size);
+
+public:
+
+	Arena(size_t block_size = 64 * 1024);
+
+	Arena(const Arena& other) = delete;
+	Arena& operator=(const Arena& other) = delete;
+
+	void* allocate(size_t size, size_t alignment);
+
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		void* memory = allocate(sizeof(T), alignof(T));
+		return new (memory) T(std::forward<Args>(args)...);
+	}
+
+	size_t bytes_used() const;
+	size_t bytes_reserved() const;
+};
+
+// lets standard containers live inside an arena, deallocation is a no-op
+template <typename T>
+struct ArenaAllocator {
+	using value_type = T;
+
+	Arena* arena;
+
+	ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+	return lhs.arena == rhs.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+	return lhs.arena != rhs.arena;
+}
@@ -1,47 +1,73 @@
 #include "ast-builder.h"
 #include <iostream>
 
-AST::AST(std::string str) {
+AST::AST(std::string_view str, Arena& arena) : children(arena) {
 	node_type = str;
 	indentation = 0;
 }
 
-AST::AST(Token token) {
+AST::AST(Token token, Arena& arena) : children(arena) {
 	node_type = token;
 	indentation = 0;
 }
 
-AST::AST(const AST& other) {
+AST::AST(const AST& other) : children(other.children) {
 	node_type = other.node_type;
-	children = other.children;
 }
 
-std::variant< std::string, Token> AST::get_root() {
+std::variant< std::string_view, Token> AST::get_root() {
 	return node_type;
 }
 
 std::vector<AST*> AST::get_children() {
-	return children;
+	return std::vector<AST*>(children.begin(), children.end());
+}
+
+size_t AST::child_count() const {
+	return children.size();
+}
+
+AST* AST::get_child(size_t index) const {
+	return children[index];
+}
+
+Token* AST::get_token() {
+	return std::get_if<Token>(&node_type);
+}
+
+void AST::add_child(AST* node) {
+	children.push_back(node);
 }
 
 void AST::add_children(std::vector<AST*> nodes) {
 	children.insert(children.end(),nodes.begin(),nodes.end());
 }
 
-void AST::print() {
+void AST::add_children(AST* first, AST* second) {
+	children.reserve(children.size() + 2);
+	children.push_back(first);
+	children.push_back(second);
+}
+
+void AST::replace_children(size_t first, size_t count, const std::vector<AST*>& nodes) {
+	children.erase(children.begin() + first, children.begin() + first + count);
+	children.insert(children.begin() + first, nodes.begin(), nodes.end());
+}
+
+void AST::print(std::string_view source, const LineTable& lines) {
 	for (unsigned i = 0; i < indentation; i++) {
 		std::cout << '\t';
 	}
 
 	if (node_type.index() == 0) {
-		std::cout << std::get<std::string>(node_type) << '\n';
+		std::cout << std::get<std::string_view>(node_type) << '\n';
 	}
 	else {
-		std::cout << std::get<Token>(node_type) << '\n';
+		std::cout << SourceToken{ std::get<Token>(node_type), source, lines } << '\n';
 	}
 
 	for (int i = 0; i < children.size(); i++) {
 		children[i]->indentation = indentation + 1;
-		children[i]->print();
+		children[i]->print(source, lines);
 	}
 }
\ No newline at end of file
@@ -1,27 +1,39 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include "token.h"
+#include "line-table.h"
+#include "arena.h"
 #include <variant>
 
+// nodes live in the Arena passed to the constructor and are freed with it, labels must outlive the arena
 class AST {
-	std::variant<std::string, Token> node_type;
+	std::variant<std::string_view, Token> node_type;
 	unsigned indentation;
 
-	std::vector<AST*> children;
+	std::vector<AST*, ArenaAllocator<AST*>> children;
 
 public:
 
-	std::variant< std::string, Token> get_root();
+	std::variant< std::string_view, Token> get_root();
 
 	std::vector<AST*> get_children();
+	size_t child_count() const;
+	AST* get_child(size_t index) const;
+
+	// nullptr for label nodes
+	Token* get_token();
 
 	AST(const AST& other);
 
-	AST(std::string str);
-	AST(Token token);
+	AST(std::string_view str, Arena& arena);
+	AST(Token token, Arena& arena);
 
+	void add_child(AST* node);
 	void add_children(std::vector<AST*>);
+	void add_children(AST* first, AST* second);
+	void replace_children(size_t first, size_t count, const std::vector<AST*>& nodes);
 
-	void print();
+	void print(std::string_view source, const LineTable& lines);
 };
@@ -0,0 +1,157 @@
+#include "batch-driver.h"
+#include "parser.h"
+#include "flat-ast.h"
+#include "arena.h"
+#include "utility_funcs.h"
+#include "mapped-file.h"
+#include "work-stealing-pool.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+std::vector<std::string> collect_batch_files(const std::vector<std::string>& inputs) {
+	std::vector<std::string> files;
+
+	for (const std::string& input : inputs) {
+		if (std::filesystem::is_directory(input)) {
+			std::vector<std::string> directory_files;
+
+			for (const auto& entry : std::filesystem::directory_iterator(input)) {
+				if (entry.is_regular_file()) {
+					directory_files.push_back(entry.path().string());
+				}
+			}
+
+			std::sort(directory_files.begin(), directory_files.end());
+			files.insert(files.end(), directory_files.begin(), directory_files.end());
+		}
+		else {
+			files.push_back(input);
+		}
+	}
+
+	return files;
+}
+
+namespace {
+
+	BatchResult parse_one(const std::string& file_name, LexerBackend backend, TokenCache* cache) {
+		BatchResult result;
+		result.file_name = file_name;
+
+		MappedFile file(file_name);
+		std::string content;
+
+		if (!file.is_open()) {
+			content = read_file(file_name);
+		}
+
+		const char* data = file.is_open() ? file.data() : content.data();
+		result.bytes = file.is_open() ? file.size() : content.size();
+
+		Lexer lexer(data, result.bytes, backend);
+		const LineTable* lines = &lexer.lines;
+
+		std::unique_ptr<CachedTokens> cached;
+		std::unique_ptr<TokenStream> stream;
+		LineTable cached_lines;
+
+		if (cache != nullptr) {
+			cached = cache->find(data, result.bytes);
+		}
+
+		if (cached != nullptr) {
+			cached_lines = LineTable(lexer.source());
+			lines = &cached_lines;
+			stream = std::make_unique<TokenStream>(cached->columns());
+		}
+		else if (cache != nullptr) {
+			lexer.produce_tokens();
+			cache->store(data, result.bytes, lexer.tokens);
+			stream = std::make_unique<TokenStream>(lexer.tokens);
+		}
+		else {
+			// tokens are lexed as the parser asks for them, the whole array is never built
+			stream = std::make_unique<TokenStream>(lexer);
+		}
+
+		// nothing reads the parser trace of a batch, it is dropped unformatted
+		TraceSink trace;
+		std::ostringstream output;
+
+		Arena arena;
+		Parser parser(*stream, lexer.source(), *lines, arena, trace);
+
+		AST* tree = parser.make_ast("Program");
+		parser.parse_code(tree);
+
+		result.error_count = parser.get_diagnostics().size();
+
+		if (result.error_count > 0) {
+			print_diagnostics(parser.get_diagnostics(), *lines, output);
+		}
+		else {
+			FlatAST flat_tree(tree);
+			flat_tree.print(lexer.source(), *lines, output);
+		}
+
+		result.output = output.str();
+
+		return result;
+	}
+}
+
+std::vector<BatchResult> parse_batch(const std::vector<std::string>& files, unsigned jobs, LexerBackend backend,
+	TokenCache* cache) {
+	std::vector<BatchResult> results(files.size());
+	WorkStealingPool pool(jobs);
+
+	for (size_t i = 0; i < files.size(); i++) {
+		pool.submit([&results, &files, i, backend, cache]() {
+			results[i] = parse_one(files[i], backend, cache);
+		});
+	}
+
+	pool.run();
+
+	return results;
+}
+
+int run_batch(const std::vector<std::string>& inputs, unsigned jobs, LexerBackend backend, TokenCache* cache) {
+	std::vector<std::string> files = collect_batch_files(inputs);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<BatchResult> results = parse_batch(files, jobs, backend, cache);
+	auto end = std::chrono::steady_clock::now();
+
+	size_t total_bytes = 0;
+	size_t failed_files = 0;
+
+	for (const BatchResult& result : results) {
+		std::cout << "== " << result.file_name << '\n' << result.output;
+		total_bytes += result.bytes;
+
+		if (result.error_count > 0) {
+			failed_files++;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	std::cerr << results.size() << " files, " << total_bytes << " bytes in " << seconds << " s on "
+		<< (jobs == 0 ? 1 : jobs) << " threads: " << results.size() / seconds << " files/s, "
+		<< total_bytes / (1024.0 * 1024.0) / seconds << " MB/s\n";
+
+	if (cache != nullptr) {
+		std::cerr << "token cache: " << cache->hit_count() << " hits, " << cache->miss_count() << " misses\n";
+	}
+
+	if (failed_files > 0) {
+		std::cerr << failed_files << " files with errors\n";
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "lexer.h"
+#include "token-cache.h"
+
+struct BatchResult {
+	std::string file_name;
+	std::string output; // the tree, or the errors when the file didn't parse
+	size_t bytes;
+	size_t error_count;
+};
+
+// expands directories into the regular files inside them, sorted so runs are reproducible
+std::vector<std::string> collect_batch_files(const std::vector<std::string>& inputs);
+
+// lexes and parses every file on its own Lexer, Parser and Arena, results keep the input order
+// with a cache, files whose tokens are in it aren't lexed and the ones that get lexed are added
+std::vector<BatchResult> parse_batch(const std::vector<std::string>& files, unsigned jobs, LexerBackend backend,
+	TokenCache* cache = nullptr);
+
+// -1 when any file had errors, every file is parsed either way
+int run_batch(const std::vector<std::string>& inputs, unsigned jobs, LexerBackend backend, TokenCache* cache = nullptr);
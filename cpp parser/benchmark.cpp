@@ -0,0 +1,705 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "lexer.h"
+#include "parser.h"
+#include "token-stream.h"
+#include "flat-ast.h"
+#include "arena.h"
+#include "source-generator.h"
+#include "char-scan.h"
+#include "parallel-lexer.h"
+#include "incremental-parser.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// every heap allocation goes through here, the size is kept in front of the block so frees can be counted
+namespace {
+	struct AllocationCounter {
+		size_t count = 0;
+		size_t bytes = 0;
+		size_t live = 0;
+		size_t peak = 0;
+	};
+
+	AllocationCounter allocations;
+
+	constexpr size_t header_size = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size) {
+	char* block = static_cast<char*>(std::malloc(size + header_size));
+
+	if (block == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	*reinterpret_cast<size_t*>(block) = size;
+
+	allocations.count++;
+	allocations.bytes += size;
+	allocations.live += size;
+
+	if (allocations.live > allocations.peak) {
+		allocations.peak = allocations.live;
+	}
+
+	return block + header_size;
+}
+
+void operator delete(void* memory) noexcept {
+	if (memory == nullptr) {
+		return;
+	}
+
+	char* block = static_cast<char*>(memory) - header_size;
+	allocations.live -= *reinterpret_cast<size_t*>(block);
+
+	std::free(block);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	operator delete(memory);
+}
+
+struct PhaseResult {
+	double seconds = 0;
+	size_t allocation_count = 0;
+	size_t allocated_bytes = 0;
+	size_t peak_heap_bytes = 0; // most heap in use at once during the phase, counted from its start
+};
+
+struct RunResult {
+	std::string mix;
+	size_t bytes = 0;
+	size_t tokens = 0;
+	size_t nodes = 0;
+	size_t errors = 0;
+	size_t printed_bytes = 0;
+
+	PhaseResult lex;
+	PhaseResult parse;
+	PhaseResult print;
+};
+
+class PhaseTimer {
+	PhaseResult& result;
+	AllocationCounter before;
+	std::chrono::steady_clock::time_point start;
+
+public:
+
+	PhaseTimer(PhaseResult& result) : result(result) {
+		before = allocations;
+		allocations.peak = allocations.live;
+		start = std::chrono::steady_clock::now();
+	}
+
+	~PhaseTimer() {
+		auto end = std::chrono::steady_clock::now();
+
+		result.seconds = std::chrono::duration<double>(end - start).count();
+		result.allocation_count = allocations.count - before.count;
+		result.allocated_bytes = allocations.bytes - before.bytes;
+		result.peak_heap_bytes = allocations.peak - before.live;
+
+		allocations.peak = std::max(allocations.peak, before.peak);
+	}
+};
+
+size_t peak_rss_bytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// one lex, parse and print of the source, every phase with its own timer and allocation counts
+RunResult run_once(const std::string& mix, const std::string& source, LexerBackend backend, unsigned lex_jobs) {
+	RunResult result;
+	result.mix = mix;
+	result.bytes = source.size();
+
+	Lexer lexer(source.data(), source.size(), backend);
+	{
+		PhaseTimer timer(result.lex);
+
+		if (lex_jobs > 1) {
+			lexer.tokens = lex_in_parallel(source.data(), source.size(), lex_jobs, lexer.lines, backend);
+		}
+		else {
+			lexer.produce_tokens();
+		}
+	}
+	result.tokens = lexer.tokens.size();
+
+	// the parse is timed without the trace, its lines are dropped before they are formatted as in batch mode
+	TraceSink trace;
+	Arena arena;
+	AST* tree = nullptr;
+	{
+		PhaseTimer timer(result.parse);
+
+		TokenStream tokens(lexer.tokens);
+		Parser parser(tokens, lexer.source(), lexer.lines, arena, trace);
+
+		tree = parser.make_ast("Program");
+		parser.parse_code(tree);
+
+		result.errors = parser.get_diagnostics().size();
+	}
+
+	std::ostringstream output;
+	{
+		PhaseTimer timer(result.print);
+
+		FlatAST flat_tree(tree);
+		flat_tree.print(lexer.source(), lexer.lines, output);
+
+		result.nodes = flat_tree.size();
+	}
+	result.printed_bytes = output.tellp();
+
+	return result;
+}
+
+double per_second(double amount, double seconds) {
+	return seconds > 0 ? amount / seconds : 0;
+}
+
+// lines of plain identifiers, keywords and identifiers that start with a keyword, nothing else to lex
+std::string make_identifier_source(size_t bytes, unsigned seed) {
+	const char* const words[] = { "count", "total", "interval", "format", "newest", "doubled", "classic",
+		"constant", "iffy", "cinder", "value_2", "int", "string", "return", "while", "cout", "public" };
+	const size_t word_count = sizeof(words) / sizeof(words[0]);
+
+	std::mt19937 rng(seed);
+	std::string source;
+	source.reserve(bytes + 64);
+
+	while (source.size() < bytes) {
+		for (unsigned i = 0; i < 8; i++) {
+			source += words[rng() % word_count];
+			source += ' ';
+		}
+		source += ";\n";
+	}
+
+	return source;
+}
+
+// deeply indented lines with blank lines between them, mostly whitespace for the lexer to skip
+std::string make_indented_source(size_t bytes, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::string source;
+	source.reserve(bytes + 256);
+
+	while (source.size() < bytes) {
+		source.append(4 * (1 + rng() % 24), ' ');
+		source += "x = 1;\n";
+
+		if (rng() % 4 == 0) {
+			source += "\r\n\n";
+		}
+	}
+
+	return source;
+}
+
+// identifiers of 16 to 80 characters and long integer constants
+std::string make_long_identifier_source(size_t bytes, unsigned seed) {
+	const char word_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+	std::mt19937 rng(seed);
+	std::string source;
+	source.reserve(bytes + 256);
+
+	while (source.size() < bytes) {
+		source += 'v';
+		for (unsigned i = 0, length = 15 + rng() % 65; i < length; i++) {
+			source += word_chars[rng() % (sizeof(word_chars) - 1)];
+		}
+
+		source += " = ";
+		source += '1' + rng() % 9;
+		for (unsigned i = 0, length = rng() % 18; i < length; i++) {
+			source += '0' + rng() % 10;
+		}
+		source += ";\n";
+	}
+
+	return source;
+}
+
+struct LexRun {
+	LexerBackend backend;
+	size_t tokens;
+	double seconds;
+};
+
+std::vector<LexRun> run_lex_benchmark(const std::string& source, unsigned repeat) {
+	std::vector<LexRun> runs;
+
+	for (LexerBackend backend : { LexerBackend::Dfa, LexerBackend::Regex }) {
+		LexRun best{ backend, 0, 0 };
+
+		for (unsigned i = 0; i < repeat; i++) {
+			auto start = std::chrono::steady_clock::now();
+
+			Lexer lexer(source.data(), source.size(), backend);
+			lexer.produce_tokens();
+
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (i == 0 || seconds < best.seconds) {
+				best.tokens = lexer.tokens.size();
+				best.seconds = seconds;
+			}
+		}
+
+		runs.push_back(best);
+	}
+
+	return runs;
+}
+
+const char* scan_level_name(ScanLevel level) {
+	switch (level) {
+	case ScanLevel::Avx2:
+		return "avx2";
+	case ScanLevel::Sse2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+void print_lex_runs(const std::string& input, const std::vector<LexRun>& runs, size_t bytes, bool json) {
+	double mb = bytes / (1024.0 * 1024.0);
+
+	if (json) {
+		std::cout << "{\n  \"input\": \"" << input << "\", \"scan\": \"" << scan_level_name(current_scan_level())
+			<< "\",\n  \"runs\": [\n";
+
+		for (size_t i = 0; i < runs.size(); i++) {
+			std::cout << "    { \"lexer\": \"" << (runs[i].backend == LexerBackend::Dfa ? "dfa" : "regex")
+				<< "\", \"bytes\": " << bytes << ", \"tokens\": " << runs[i].tokens
+				<< ", \"seconds\": " << runs[i].seconds
+				<< ", \"tokens_per_s\": " << per_second(runs[i].tokens, runs[i].seconds)
+				<< ", \"mb_per_s\": " << per_second(mb, runs[i].seconds) << " }" << (i + 1 < runs.size() ? ",\n" : "\n");
+		}
+
+		std::cout << "  ]\n}\n";
+		return;
+	}
+
+	std::cout << "input\tscan\tlexer\tsize_mb\ttokens\tseconds\ttokens_per_s\tmb_per_s\n";
+
+	for (const LexRun& run : runs) {
+		std::cout << input << '\t' << scan_level_name(current_scan_level()) << '\t'
+			<< (run.backend == LexerBackend::Dfa ? "dfa" : "regex") << '\t' << mb << '\t' << run.tokens << '\t'
+			<< run.seconds << '\t' << per_second(run.tokens, run.seconds) << '\t' << per_second(mb, run.seconds) << '\n';
+	}
+}
+
+// the tokens, the tree and the errors a full parse of the source prints
+std::string print_full_parse(const std::string& source, LexerBackend backend) {
+	Lexer lexer(source.data(), source.size(), backend);
+	lexer.produce_tokens();
+
+	TraceSink discard;
+	Arena arena;
+	TokenStream tokens(lexer.tokens);
+	Parser parser(tokens, lexer.source(), lexer.lines, arena, discard);
+
+	AST* tree = parser.make_ast("Program");
+	parser.parse_code(tree);
+
+	std::ostringstream output;
+	lexer.print_tokens(output);
+	FlatAST(tree).print(lexer.source(), lexer.lines, output);
+	print_diagnostics(parser.get_diagnostics(), lexer.lines, output);
+
+	return output.str();
+}
+
+// the same for what an incremental session holds after its edits
+std::string print_session(const IncrementalParser& session) {
+	std::ostringstream output;
+	print_tokens(session.get_tokens().columns(), session.source(), session.get_lines(), output);
+	FlatAST(session.tree()).print(session.source(), session.get_lines(), output);
+	print_diagnostics(session.get_diagnostics(), session.get_lines(), output);
+
+	return output.str();
+}
+
+// an edit at a random token, the kinds an editor sends while typing: a token retyped as another one, spaces or a
+// line break before it, the token deleted, a ( or ; that breaks the statement, a run of tokens pasted or cut
+TextEdit random_edit(const IncrementalParser& session, std::mt19937& rng) {
+	const TokenArray& tokens = session.get_tokens();
+	std::string_view text = session.source();
+	size_t count = tokens.size() - 1; // EndOfTokens is never edited
+
+	if (count == 0) {
+		return TextEdit{ 0, 0, "int x;\n" };
+	}
+
+	size_t index = rng() % count;
+	Token token = tokens[index];
+	size_t run_end = std::min(count, index + 1 + rng() % 40) - 1;
+	size_t run_bytes = tokens[run_end].offset + tokens[run_end].length - token.offset;
+
+	switch (rng() % 8) {
+	case 0:
+		return TextEdit{ token.offset, token.length, std::string(tokens[rng() % count].value(text)) };
+	case 1:
+		return TextEdit{ token.offset, 0, std::string(1 + rng() % 3, ' ') };
+	case 2:
+		return TextEdit{ token.offset, 0, "\n" };
+	case 3:
+		return TextEdit{ token.offset, token.length, "" };
+	case 4:
+		return TextEdit{ token.offset, 0, "(" };
+	case 5:
+		return TextEdit{ token.offset, 0, "; " };
+	case 6:
+		return TextEdit{ tokens[rng() % count].offset, 0, std::string(text.substr(token.offset, run_bytes)) + '\n' };
+	default:
+		return TextEdit{ token.offset, run_bytes, "" };
+	}
+}
+
+struct EditRun {
+	std::string mix;
+	unsigned seed = 0;
+	size_t bytes = 0;
+	size_t edits = 0;
+	double initial_seconds = 0; // lexing and parsing the whole source when the session starts
+	double edit_seconds = 0;
+	double slowest_edit_seconds = 0;
+	bool checked = false;
+};
+
+// applies random edits to one session and times each, with check the session after every edit is compared with a
+// full parse of its text, false and the edit on std::cerr at the first difference
+bool run_edit_benchmark(EditRun& run, const std::string& source, unsigned edits, unsigned seed, bool check,
+	LexerBackend backend) {
+	run.seed = seed;
+	run.bytes = source.size();
+	run.checked = check;
+
+	auto start = std::chrono::steady_clock::now();
+	IncrementalParser session(source, backend);
+	run.initial_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::mt19937 rng(seed);
+
+	for (unsigned i = 0; i < edits; i++) {
+		TextEdit edit = random_edit(session, rng);
+
+		start = std::chrono::steady_clock::now();
+		session.apply(edit);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		run.edits++;
+		run.edit_seconds += seconds;
+		run.slowest_edit_seconds = std::max(run.slowest_edit_seconds, seconds);
+
+		if (check && print_session(session) != print_full_parse(std::string(session.source()), backend)) {
+			std::cerr << run.mix << " seed " << seed << ": edit " << i << " at offset " << edit.offset << " removing " << edit.removed << " bytes and inserting \""
+				<< edit.inserted << "\" differs from a full parse\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// inputs the check has found differences on before, a --check run without --mix goes over them too
+struct EditCase {
+	const char* mix;
+	size_t size_kb;
+	unsigned seed;
+};
+
+const EditCase known_edit_cases[] = {
+	{ "errors:1,comments:1,output:1", 8, 11 },
+	{ "errors:1,comments:1,output:1", 8, 13 }
+};
+
+void print_edit_runs(const std::vector<EditRun>& runs, bool json) {
+	if (json) {
+		std::cout << "{\n  \"runs\": [\n";
+
+		for (size_t i = 0; i < runs.size(); i++) {
+			const EditRun& run = runs[i];
+
+			std::cout << "    { \"mix\": \"" << run.mix << "\", \"seed\": " << run.seed << ", \"bytes\": " << run.bytes << ", \"edits\": " << run.edits
+				<< ", \"initial_seconds\": " << run.initial_seconds
+				<< ", \"average_edit_seconds\": " << run.edit_seconds / std::max<size_t>(run.edits, 1)
+				<< ", \"slowest_edit_seconds\": " << run.slowest_edit_seconds
+				<< ", \"checked\": " << (run.checked ? "true" : "false") << " }" << (i + 1 < runs.size() ? ",\n" : "\n");
+		}
+
+		std::cout << "  ]\n}\n";
+		return;
+	}
+
+	std::cout << "mix\tseed\tsize_mb\tedits\tinitial_s\tavg_edit_us\tmax_edit_us\tchecked\n";
+
+	for (const EditRun& run : runs) {
+		std::cout << run.mix << '\t' << run.seed << '\t' << run.bytes / (1024.0 * 1024.0) << '\t' << run.edits << '\t' << run.initial_seconds << '\t'
+			<< run.edit_seconds / std::max<size_t>(run.edits, 1) * 1e6 << '\t' << run.slowest_edit_seconds * 1e6 << '\t'
+			<< (run.checked ? "yes" : "no") << '\n';
+	}
+}
+
+void print_phase_json(const char* name, const PhaseResult& phase, const char* unit, double amount, bool last) {
+	std::cout << "      \"" << name << "\": { \"seconds\": " << phase.seconds
+		<< ", \"" << unit << "_per_s\": " << per_second(amount, phase.seconds)
+		<< ", \"allocations\": " << phase.allocation_count
+		<< ", \"allocated_bytes\": " << phase.allocated_bytes
+		<< ", \"peak_heap_bytes\": " << phase.peak_heap_bytes << " }" << (last ? "\n" : ",\n");
+}
+
+void print_json(const std::vector<RunResult>& runs, unsigned seed, unsigned repeat, LexerBackend backend, unsigned lex_jobs) {
+	std::cout.precision(6);
+	std::cout << "{\n  \"seed\": " << seed << ", \"repeat\": " << repeat
+		<< ", \"lexer\": \"" << (backend == LexerBackend::Dfa ? "dfa" : "regex")
+		<< "\", \"scan\": \"" << scan_level_name(current_scan_level()) << "\", \"lex_jobs\": " << lex_jobs
+		<< ",\n  \"runs\": [\n";
+
+	for (size_t i = 0; i < runs.size(); i++) {
+		const RunResult& run = runs[i];
+
+		std::cout << "    {\n      \"mix\": \"" << run.mix << "\", \"bytes\": " << run.bytes
+			<< ", \"tokens\": " << run.tokens << ", \"nodes\": " << run.nodes << ", \"errors\": " << run.errors
+			<< ", \"printed_bytes\": " << run.printed_bytes << ",\n";
+
+		print_phase_json("lex", run.lex, "tokens", run.tokens, false);
+		print_phase_json("parse", run.parse, "nodes", run.nodes, false);
+		print_phase_json("print", run.print, "nodes", run.nodes, true);
+
+		std::cout << "    }" << (i + 1 < runs.size() ? ",\n" : "\n");
+	}
+
+	std::cout << "  ],\n  \"peak_rss_bytes\": " << peak_rss_bytes() << "\n}\n";
+}
+
+void print_table(const std::vector<RunResult>& runs) {
+	std::cout << "mix\tsize_mb\ttokens\tnodes\terrors\tlex_s\ttokens_per_s\tlex_allocs\tparse_s\tnodes_per_s\tparse_allocs"
+		"\tprint_s\tprint_allocs\tpeak_heap_mb\n";
+
+	for (const RunResult& run : runs) {
+		size_t peak = std::max(run.lex.peak_heap_bytes, std::max(run.parse.peak_heap_bytes, run.print.peak_heap_bytes));
+
+		std::cout << run.mix << '\t' << run.bytes / (1024.0 * 1024.0) << '\t' << run.tokens << '\t' << run.nodes << '\t' << run.errors << '\t'
+			<< run.lex.seconds << '\t' << per_second(run.tokens, run.lex.seconds) << '\t' << run.lex.allocation_count << '\t'
+			<< run.parse.seconds << '\t' << per_second(run.nodes, run.parse.seconds) << '\t' << run.parse.allocation_count << '\t'
+			<< run.print.seconds << '\t' << run.print.allocation_count << '\t'
+			<< peak / (1024.0 * 1024.0) << '\n';
+	}
+
+	std::cout << "peak_rss_mb\t" << peak_rss_bytes() / (1024.0 * 1024.0) << '\n';
+}
+
+// benchmark [--size-kb=N] [--mix=name|weights]... [--seed=N] [--repeat=N] [--lexer=regex|dfa] [--scan=scalar|sse2|avx2]
+//           [--lex-jobs=N] [--json]
+// without --mix every preset is run, the fastest of the repeats is reported
+// benchmark --identifiers|--indentation|--long-identifiers [--size-kb=N] [--repeat=N] [--scan=...] [--json]
+// only lexes that kind of input with both backends
+// benchmark --incremental [--edits=N] [--check] [--size-kb=N] [--mix=...]... [--seed=N] [--lexer=...] [--json]
+// times random edits to an IncrementalParser session, --check compares it with a full parse after each one and
+// without --mix also runs the inputs it has found differences on before
+int main(int argc, char* argv[]) {
+	size_t size_kb = 1024;
+	unsigned seed = 1;
+	unsigned repeat = 3;
+	unsigned lex_jobs = 1;
+	bool json = false;
+	bool incremental = false;
+	bool check = false;
+	unsigned edits = 1000;
+	std::string lex_only;
+	LexerBackend backend = LexerBackend::Dfa;
+	std::vector<std::string> mixes;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg.rfind("--size-kb=", 0) == 0) {
+			size_kb = std::stoul(arg.substr(10));
+		}
+		else if (arg.rfind("--mix=", 0) == 0) {
+			mixes.push_back(arg.substr(6));
+		}
+		else if (arg.rfind("--seed=", 0) == 0) {
+			seed = std::stoul(arg.substr(7));
+		}
+		else if (arg.rfind("--repeat=", 0) == 0) {
+			repeat = std::stoul(arg.substr(9));
+
+			if (repeat == 0) {
+				repeat = 1;
+			}
+		}
+		else if (arg.rfind("--lex-jobs=", 0) == 0) {
+			lex_jobs = std::stoul(arg.substr(11));
+		}
+		else if (arg == "--lexer=regex") {
+			backend = LexerBackend::Regex;
+		}
+		else if (arg == "--lexer=dfa") {
+			backend = LexerBackend::Dfa;
+		}
+		else if (arg == "--scan=scalar") {
+			set_scan_level(ScanLevel::Scalar);
+		}
+		else if (arg == "--scan=sse2") {
+			set_scan_level(ScanLevel::Sse2);
+		}
+		else if (arg == "--scan=avx2") {
+			set_scan_level(ScanLevel::Avx2);
+		}
+		else if (arg == "--json") {
+			json = true;
+		}
+		else if (arg == "--incremental") {
+			incremental = true;
+		}
+		else if (arg.rfind("--edits=", 0) == 0) {
+			edits = std::stoul(arg.substr(8));
+		}
+		else if (arg == "--check") {
+			check = true;
+		}
+		else if (arg == "--identifiers" || arg == "--indentation" || arg == "--long-identifiers") {
+			lex_only = arg.substr(2);
+		}
+		else {
+			std::cerr << "unknown argument " << arg << '\n';
+			return 1;
+		}
+	}
+
+	if (!lex_only.empty()) {
+		std::string source;
+
+		if (lex_only == "identifiers") {
+			source = make_identifier_source(size_kb * 1024, seed);
+		}
+		else if (lex_only == "indentation") {
+			source = make_indented_source(size_kb * 1024, seed);
+		}
+		else {
+			source = make_long_identifier_source(size_kb * 1024, seed);
+		}
+
+		print_lex_runs(lex_only, run_lex_benchmark(source, repeat), source.size(), json);
+
+		return 0;
+	}
+
+	if (incremental) {
+		std::vector<EditCase> cases;
+
+		if (mixes.empty()) {
+			mixes = { "mixed", "errors:1,classes:1,nesting:1" };
+
+			if (check) {
+				cases.assign(std::begin(known_edit_cases), std::end(known_edit_cases));
+			}
+		}
+
+		for (size_t i = 0; i < mixes.size(); i++) {
+			cases.insert(cases.begin() + i, EditCase{ mixes[i].c_str(), size_kb, seed });
+		}
+
+		std::vector<EditRun> runs;
+		bool same = true;
+
+		for (const EditCase& edit_case : cases) {
+			ConstructMix mix;
+
+			if (!parse_construct_mix(edit_case.mix, mix)) {
+				std::cerr << "unknown mix " << edit_case.mix << '\n';
+				return 1;
+			}
+
+			EditRun run;
+			run.mix = edit_case.mix;
+
+			std::string source = SourceGenerator(mix, edit_case.seed).generate(edit_case.size_kb * 1024);
+			same = run_edit_benchmark(run, source, edits, edit_case.seed, check, backend) && same;
+
+			runs.push_back(run);
+		}
+
+		print_edit_runs(runs, json);
+
+		return same ? 0 : 1;
+	}
+
+	if (mixes.empty()) {
+		mixes = { "mixed", "arithmetic", "nesting", "classes", "strings", "output", "comments:1,arithmetic:1",
+			"errors:1,arithmetic:1" };
+	}
+
+	std::vector<RunResult> runs;
+
+	for (const std::string& mix_name : mixes) {
+		ConstructMix mix;
+
+		if (!parse_construct_mix(mix_name, mix)) {
+			std::cerr << "unknown mix " << mix_name << '\n';
+			return 1;
+		}
+
+		std::string source = SourceGenerator(mix, seed).generate(size_kb * 1024);
+		RunResult best;
+
+		for (unsigned i = 0; i < repeat; i++) {
+			RunResult run = run_once(mix_name, source, backend, lex_jobs);
+
+			if (i == 0 || run.lex.seconds + run.parse.seconds + run.print.seconds
+				< best.lex.seconds + best.parse.seconds + best.print.seconds) {
+				best = run;
+			}
+		}
+
+		runs.push_back(best);
+	}
+
+	if (json) {
+		print_json(runs, seed, repeat, backend, lex_jobs);
+	}
+	else {
+		print_table(runs);
+	}
+
+	return 0;
+}
@@ -0,0 +1,361 @@
+#include "char-scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CHAR_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+	bool is_blank(unsigned char c) {
+		return c == ' ' || c == '\n' || c == '\r';
+	}
+
+	bool is_digit(unsigned char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	bool is_word_char(unsigned char c) {
+		return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+	}
+
+	template <bool (*in_class)(unsigned char)>
+	size_t span_scalar(const char* begin, const char* end) {
+		const char* it = begin;
+
+		while (it != end && in_class(static_cast<unsigned char>(*it))) {
+			it++;
+		}
+
+		return it - begin;
+	}
+
+	bool is_space(unsigned char c) {
+		return c == ' ';
+	}
+
+	size_t count_newlines_scalar(const char* begin, const char* end) {
+		size_t count = 0;
+
+		for (const char* it = begin; it != end; it++) {
+			count += *it == '\n';
+		}
+
+		return count;
+	}
+
+	size_t find_pair_scalar(const char* begin, const char* end, char first, char second) {
+		for (const char* it = begin; end - it >= 2; it++) {
+			if (it[0] == first && it[1] == second) {
+				return it - begin;
+			}
+		}
+
+		return end - begin;
+	}
+
+	struct ScanFunctions {
+		size_t (*spaces)(const char*, const char*);
+		size_t (*blanks)(const char*, const char*);
+		size_t (*word_chars)(const char*, const char*);
+		size_t (*digits)(const char*, const char*);
+		size_t (*newlines)(const char*, const char*);
+		size_t (*pair)(const char*, const char*, char, char);
+	};
+
+	const ScanFunctions scalar_functions{
+		span_scalar<is_space>, span_scalar<is_blank>, span_scalar<is_word_char>, span_scalar<is_digit>, count_newlines_scalar,
+		find_pair_scalar
+	};
+
+#ifdef CHAR_SCAN_X86
+
+	unsigned first_zero_bit(unsigned mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, ~mask);
+		return index;
+#else
+		return __builtin_ctz(~mask);
+#endif
+	}
+
+	unsigned first_set_bit(unsigned mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	unsigned bit_count(unsigned mask) {
+#ifdef _MSC_VER
+		return __popcnt(mask);
+#else
+		return __builtin_popcount(mask);
+#endif
+	}
+
+	// bytes in [low, high], signed compares are fine since everything tested for is ascii
+	__m128i in_range_sse2(__m128i bytes, char low, char high) {
+		return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(low - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(high + 1)));
+	}
+
+	__m128i spaces_sse2(__m128i bytes) {
+		return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+	}
+
+	__m128i blanks_sse2(__m128i bytes) {
+		return _mm_or_si128(spaces_sse2(bytes),
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+	}
+
+	__m128i digits_sse2(__m128i bytes) {
+		return in_range_sse2(bytes, '0', '9');
+	}
+
+	// setting 0x20 lowercases letters and moves nothing else into a-z
+	__m128i word_chars_sse2(__m128i bytes) {
+		__m128i letters = in_range_sse2(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 'z');
+		__m128i underscore = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+
+		return _mm_or_si128(_mm_or_si128(letters, underscore), digits_sse2(bytes));
+	}
+
+	template <__m128i (*in_class)(__m128i), bool (*in_class_scalar)(unsigned char)>
+	size_t span_sse2(const char* begin, const char* end) {
+		const char* it = begin;
+
+		for (; end - it >= 16; it += 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+			unsigned mask = _mm_movemask_epi8(in_class(bytes));
+
+			if (mask != 0xffff) {
+				return it - begin + first_zero_bit(mask);
+			}
+		}
+
+		return it - begin + span_scalar<in_class_scalar>(it, end);
+	}
+
+	size_t count_newlines_sse2(const char* begin, const char* end) {
+		const char* it = begin;
+		size_t count = 0;
+
+		for (; end - it >= 16; it += 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+			count += bit_count(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))));
+		}
+
+		return count + count_newlines_scalar(it, end);
+	}
+
+	// the second byte is compared in a load shifted by one, so a block needs one byte past it
+	size_t find_pair_sse2(const char* begin, const char* end, char first, char second) {
+		const char* it = begin;
+
+		for (; end - it >= 17; it += 16) {
+			__m128i firsts = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)), _mm_set1_epi8(first));
+			__m128i seconds = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 1)), _mm_set1_epi8(second));
+			unsigned mask = _mm_movemask_epi8(_mm_and_si128(firsts, seconds));
+
+			if (mask != 0) {
+				return it - begin + first_set_bit(mask);
+			}
+		}
+
+		return it - begin + find_pair_scalar(it, end, first, second);
+	}
+
+	const ScanFunctions sse2_functions{
+		span_sse2<spaces_sse2, is_space>, span_sse2<blanks_sse2, is_blank>,
+		span_sse2<word_chars_sse2, is_word_char>, span_sse2<digits_sse2, is_digit>, count_newlines_sse2,
+		find_pair_sse2
+	};
+
+	// gcc and clang only emit avx2 inside functions marked for it, msvc emits whatever intrinsic is used
+#if defined(__GNUC__) || defined(__clang__)
+#define CHAR_SCAN_AVX2 __attribute__((target("avx2")))
+#else
+#define CHAR_SCAN_AVX2
+#endif
+
+	CHAR_SCAN_AVX2 __m256i in_range_avx2(__m256i bytes, char low, char high) {
+		return _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(low - 1)),
+			_mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), bytes));
+	}
+
+	CHAR_SCAN_AVX2 __m256i spaces_avx2(__m256i bytes) {
+		return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+	}
+
+	CHAR_SCAN_AVX2 __m256i blanks_avx2(__m256i bytes) {
+		return _mm256_or_si256(spaces_avx2(bytes),
+			_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+	}
+
+	CHAR_SCAN_AVX2 __m256i digits_avx2(__m256i bytes) {
+		return in_range_avx2(bytes, '0', '9');
+	}
+
+	CHAR_SCAN_AVX2 __m256i word_chars_avx2(__m256i bytes) {
+		__m256i letters = in_range_avx2(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 'z');
+		__m256i underscore = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_'));
+
+		return _mm256_or_si256(_mm256_or_si256(letters, underscore), digits_avx2(bytes));
+	}
+
+	template <__m256i (*in_class)(__m256i), __m128i (*in_class_sse2)(__m128i), bool (*in_class_scalar)(unsigned char)>
+	CHAR_SCAN_AVX2 size_t span_avx2(const char* begin, const char* end) {
+		const char* it = begin;
+
+		for (; end - it >= 32; it += 32) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+			unsigned mask = _mm256_movemask_epi8(in_class(bytes));
+
+			if (mask != 0xffffffff) {
+				return it - begin + first_zero_bit(mask);
+			}
+		}
+
+		return it - begin + span_sse2<in_class_sse2, in_class_scalar>(it, end);
+	}
+
+	CHAR_SCAN_AVX2 size_t count_newlines_avx2(const char* begin, const char* end) {
+		const char* it = begin;
+		size_t count = 0;
+
+		for (; end - it >= 32; it += 32) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+			count += bit_count(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))));
+		}
+
+		return count + count_newlines_sse2(it, end);
+	}
+
+	CHAR_SCAN_AVX2 size_t find_pair_avx2(const char* begin, const char* end, char first, char second) {
+		const char* it = begin;
+
+		for (; end - it >= 33; it += 32) {
+			__m256i firsts = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), _mm256_set1_epi8(first));
+			__m256i seconds = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + 1)), _mm256_set1_epi8(second));
+			unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(firsts, seconds));
+
+			if (mask != 0) {
+				return it - begin + first_set_bit(mask);
+			}
+		}
+
+		return it - begin + find_pair_sse2(it, end, first, second);
+	}
+
+	const ScanFunctions avx2_functions{
+		span_avx2<spaces_avx2, spaces_sse2, is_space>, span_avx2<blanks_avx2, blanks_sse2, is_blank>,
+		span_avx2<word_chars_avx2, word_chars_sse2, is_word_char>, span_avx2<digits_avx2, digits_sse2, is_digit>,
+		count_newlines_avx2, find_pair_avx2
+	};
+
+	bool cpu_has_avx2() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// the os has to save the ymm registers too
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+
+		if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	bool cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+#endif
+
+	ScanLevel detect_scan_level() {
+#ifdef CHAR_SCAN_X86
+		if (cpu_has_avx2()) {
+			return ScanLevel::Avx2;
+		}
+		if (cpu_has_sse2()) {
+			return ScanLevel::Sse2;
+		}
+#endif
+		return ScanLevel::Scalar;
+	}
+
+	const ScanFunctions& functions_for(ScanLevel level) {
+#ifdef CHAR_SCAN_X86
+		if (level == ScanLevel::Avx2) {
+			return avx2_functions;
+		}
+		if (level == ScanLevel::Sse2) {
+			return sse2_functions;
+		}
+#endif
+		return scalar_functions;
+	}
+
+	const ScanLevel supported = detect_scan_level();
+	ScanLevel level = supported;
+	const ScanFunctions* functions = &functions_for(supported);
+}
+
+ScanLevel supported_scan_level() {
+	return supported;
+}
+
+ScanLevel current_scan_level() {
+	return level;
+}
+
+void set_scan_level(ScanLevel requested) {
+	level = requested > supported ? supported : requested;
+	functions = &functions_for(level);
+}
+
+size_t span_spaces(const char* begin, const char* end) {
+	return functions->spaces(begin, end);
+}
+
+size_t span_blanks(const char* begin, const char* end) {
+	return functions->blanks(begin, end);
+}
+
+size_t span_word_chars(const char* begin, const char* end) {
+	return functions->word_chars(begin, end);
+}
+
+size_t span_digits(const char* begin, const char* end) {
+	return functions->digits(begin, end);
+}
+
+size_t count_newlines(const char* begin, const char* end) {
+	return functions->newlines(begin, end);
+}
+
+size_t find_pair(const char* begin, const char* end, char first, char second) {
+	return functions->pair(begin, end, first, second);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+
+// widest instruction set the scanning functions use, picked once at startup from what the cpu supports
+enum class ScanLevel {
+	Scalar,
+	Sse2,
+	Avx2
+};
+
+ScanLevel supported_scan_level();
+ScanLevel current_scan_level();
+
+// for benchmarks and tests, a level above supported_scan_level() is lowered to it
+void set_scan_level(ScanLevel level);
+
+// each returns how many bytes from begin belong to the class, stopping at end
+size_t span_spaces(const char* begin, const char* end);     // ' '
+size_t span_blanks(const char* begin, const char* end);     // ' ', '\r' and '\n'
+size_t span_word_chars(const char* begin, const char* end); // [A-Za-z0-9_]
+size_t span_digits(const char* begin, const char* end);     // [0-9]
+
+size_t count_newlines(const char* begin, const char* end);
+
+// where the first "first second" pair starts, end - begin if there is none
+size_t find_pair(const char* begin, const char* end, char first, char second);
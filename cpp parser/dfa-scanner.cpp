@@ -0,0 +1,376 @@
+#include "dfa-scanner.h"
+#include <bitset>
+#include <map>
+#include <algorithm>
+
+namespace {
+
+	struct NfaState {
+		std::bitset<256> chars;
+		int next = -1;
+		std::vector<int> epsilon;
+		int rule = -1;
+	};
+
+	struct Fragment {
+		int start;
+		int end;
+	};
+
+	// thompson construction for the regex subset used by the lexer rules:
+	// literals, escapes, [classes], ., groups, |, *, + and ?
+	class NfaBuilder {
+		const std::string pattern;
+		size_t pos;
+		std::vector<NfaState>& states;
+
+		int new_state() {
+			states.push_back(NfaState());
+			return states.size() - 1;
+		}
+
+		bool at_end() const {
+			return pos >= pattern.size();
+		}
+
+		Fragment char_set(const std::bitset<256>& set) {
+			int start = new_state();
+			int end = new_state();
+
+			states[start].chars = set;
+			states[start].next = end;
+
+			return Fragment{ start, end };
+		}
+
+		std::bitset<256> parse_class() {
+			std::bitset<256> set;
+			bool negated = false;
+
+			if (!at_end() && pattern[pos] == '^') {
+				negated = true;
+				pos++;
+			}
+
+			while (!at_end() && pattern[pos] != ']') {
+				unsigned char from = pattern[pos++];
+
+				if (from == '\\' && !at_end()) {
+					from = pattern[pos++];
+				}
+
+				if (pos + 1 < pattern.size() && pattern[pos] == '-' && pattern[pos + 1] != ']') {
+					unsigned char to = pattern[pos + 1];
+					pos += 2;
+
+					for (unsigned c = from; c <= to; c++) {
+						set.set(c);
+					}
+				}
+				else {
+					set.set(from);
+				}
+			}
+			pos++; // removing the ]
+
+			if (negated) {
+				set.flip();
+			}
+
+			return set;
+		}
+
+		Fragment parse_atom() {
+			unsigned char c = pattern[pos++];
+			std::bitset<256> set;
+
+			if (c == '(') {
+				Fragment inner = parse_alternation();
+				pos++; // removing the )
+
+				return inner;
+			}
+
+			if (c == '[') {
+				set = parse_class();
+			}
+			else if (c == '.') {
+				set.set();
+				set.reset('\n');
+				set.reset('\r');
+			}
+			else if (c == '\\' && !at_end()) {
+				set.set(static_cast<unsigned char>(pattern[pos++]));
+			}
+			else {
+				set.set(c);
+			}
+
+			return char_set(set);
+		}
+
+		Fragment parse_repetition() {
+			Fragment fragment = parse_atom();
+
+			while (!at_end() && (pattern[pos] == '*' || pattern[pos] == '+' || pattern[pos] == '?')) {
+				char op = pattern[pos++];
+
+				int start = new_state();
+				int end = new_state();
+
+				states[start].epsilon.push_back(fragment.start);
+				states[fragment.end].epsilon.push_back(end);
+
+				if (op == '*' || op == '?') {
+					states[start].epsilon.push_back(end);
+				}
+				if (op == '*' || op == '+') {
+					states[fragment.end].epsilon.push_back(fragment.start);
+				}
+
+				fragment = Fragment{ start, end };
+			}
+
+			return fragment;
+		}
+
+		Fragment parse_concatenation() {
+			int start = new_state();
+			Fragment result{ start, start };
+
+			while (!at_end() && pattern[pos] != '|' && pattern[pos] != ')') {
+				Fragment next = parse_repetition();
+
+				states[result.end].epsilon.push_back(next.start);
+				result.end = next.end;
+			}
+
+			return result;
+		}
+
+		Fragment parse_alternation() {
+			Fragment result = parse_concatenation();
+
+			while (!at_end() && pattern[pos] == '|') {
+				pos++;
+				Fragment other = parse_concatenation();
+
+				int start = new_state();
+				int end = new_state();
+
+				states[start].epsilon.push_back(result.start);
+				states[start].epsilon.push_back(other.start);
+				states[result.end].epsilon.push_back(end);
+				states[other.end].epsilon.push_back(end);
+
+				result = Fragment{ start, end };
+			}
+
+			return result;
+		}
+
+	public:
+
+		NfaBuilder(const std::string& pattern, std::vector<NfaState>& states)
+			: pattern(pattern), pos(0), states(states) {}
+
+		Fragment build() {
+			return parse_alternation();
+		}
+	};
+
+	std::vector<int> epsilon_closure(const std::vector<NfaState>& states, std::vector<int> set) {
+		std::vector<bool> seen(states.size(), false);
+		std::vector<int> stack = set;
+
+		for (int s : set) {
+			seen[s] = true;
+		}
+
+		while (!stack.empty()) {
+			int s = stack.back();
+			stack.pop_back();
+
+			for (int next : states[s].epsilon) {
+				if (!seen[next]) {
+					seen[next] = true;
+					set.push_back(next);
+					stack.push_back(next);
+				}
+			}
+		}
+
+		std::sort(set.begin(), set.end());
+		return set;
+	}
+}
+
+DfaScanner::DfaScanner(const std::vector<ScanRule>& rules) {
+	std::vector<NfaState> states;
+	states.push_back(NfaState());
+
+	for (unsigned i = 0; i < rules.size(); i++) {
+		NfaBuilder builder(rules[i].pattern, states);
+		Fragment fragment = builder.build();
+
+		states[0].epsilon.push_back(fragment.start);
+		states[fragment.end].rule = i;
+		rule_types.push_back(rules[i].type);
+	}
+
+	// bytes that no rule tells apart share a column in the transition table
+	std::map<std::vector<bool>, unsigned> signatures;
+	std::vector<unsigned char> representatives;
+
+	for (unsigned c = 0; c < 256; c++) {
+		std::vector<bool> signature;
+
+		for (const NfaState& state : states) {
+			if (state.next != -1) {
+				signature.push_back(state.chars.test(c));
+			}
+		}
+
+		auto it = signatures.find(signature);
+
+		if (it == signatures.end()) {
+			it = signatures.insert({ signature, representatives.size() }).first;
+			representatives.push_back(c);
+		}
+		byte_class[c] = it->second;
+	}
+	class_count = representatives.size();
+
+	// subset construction
+	std::map<std::vector<int>, int> dfa_states;
+	std::vector<std::vector<int>> worklist;
+
+	auto add_state = [&](const std::vector<int>& set) {
+		auto it = dfa_states.find(set);
+
+		if (it != dfa_states.end()) {
+			return it->second;
+		}
+
+		int id = worklist.size();
+		dfa_states.insert({ set, id });
+		worklist.push_back(set);
+
+		int rule = -1;
+		for (int s : set) {
+			if (states[s].rule != -1 && (rule == -1 || states[s].rule < rule)) {
+				rule = states[s].rule;
+			}
+		}
+		accepting_rule.push_back(rule);
+		transitions.resize(transitions.size() + class_count, -1);
+
+		return id;
+	};
+
+	add_state(epsilon_closure(states, std::vector<int>{ 0 }));
+
+	for (unsigned i = 0; i < worklist.size(); i++) {
+		for (unsigned c = 0; c < class_count; c++) {
+			std::vector<int> moved;
+
+			for (int s : worklist[i]) {
+				if (states[s].next != -1 && states[s].chars.test(representatives[c])) {
+					moved.push_back(states[s].next);
+				}
+			}
+
+			if (moved.empty()) {
+				continue;
+			}
+
+			int target = add_state(epsilon_closure(states, moved));
+			transitions[i * class_count + c] = target;
+		}
+	}
+}
+
+// runs until the automaton dies; the winner is the earliest rule that matched anywhere along the way,
+// taken at its longest match, which is what the regex chain in Lexer::match_token returns
+ScanResult DfaScanner::scan(const char* begin, const char* end) const {
+	int state = 0;
+	int best_rule = -1;
+	unsigned best_length = 0;
+	unsigned examined = end - begin + 1;
+
+	for (const char* it = begin; it != end; it++) {
+		state = transitions[state * class_count + byte_class[static_cast<unsigned char>(*it)]];
+
+		if (state == -1) {
+			examined = it - begin + 1;
+			break;
+		}
+
+		int rule = accepting_rule[state];
+
+		if (rule != -1 && (best_rule == -1 || rule <= best_rule)) {
+			best_rule = rule;
+			best_length = it - begin + 1;
+		}
+	}
+
+	if (best_rule == -1) {
+		return ScanResult{ false, TokenType::EndOfTokens, 0, examined };
+	}
+
+	return ScanResult{ true, rule_types[best_rule], best_length, examined };
+}
+
+unsigned DfaScanner::state_count() const {
+	return accepting_rule.size();
+}
+
+const DfaScanner& DfaScanner::lexer_rules() {
+	// same patterns and order as Lexer::match_token, minus the ones Lexer::match_fast_path takes before it
+	static const DfaScanner scanner(std::vector<ScanRule>{
+		{ "\r?\n", TokenType::NewLine },
+		{ "[+-]?([0-9]+('[0-9]+)*)?[.][0-9]+('[0-9]+)*([eE][+-]?[0-9]+)?|[+-]?[0-9]+('[0-9]+)*[eE][+-]?[0-9]+", TokenType::FloatConst },
+		{ "0[xX][0-9a-fA-F]+('[0-9a-fA-F]+)*|0[bB][01]+('[01]+)*|[0]|[-+]?[1-9][0-9]*('[0-9]+)*", TokenType::IntConst },
+		{ R"('[^'\\]'|'\\a'|'\\b'|'\\f'|'\\n'|'\\r'|'\\t'|'\\v'|'\\''|'\\\\'|'\\"'|'\\?')", TokenType::CharConst },
+		{ "#include", TokenType::IncludeDirective },
+		{ "\\(", TokenType::LeftParen },
+		{ "\\)", TokenType::RightParen },
+		{ "\\{", TokenType::LeftBrace },
+		{ "\\}", TokenType::RightBrace },
+		{ ":", TokenType::Colon },
+		{ ";", TokenType::Semicolon },
+		{ ",", TokenType::Comma },
+		{ "\\.", TokenType::DotOperator },
+		{ "\\[\\]|\\[(0|[1-9][0-9]*)\\]", TokenType::BracketOperator },
+		{ "==", TokenType::EqualEqual },
+		{ "=", TokenType::Equal },
+		{ ">=", TokenType::GreaterEqual },
+		{ "<=", TokenType::LessEqual },
+		{ "!=", TokenType::NotEqual },
+		{ "<<", TokenType::LeftShift },
+		{ ">>", TokenType::RightShift },
+		{ "<", TokenType::Less },
+		{ ">", TokenType::Greater },
+		{ "\\+\\+", TokenType::PlusPlus },
+		{ "--", TokenType::MinusMinus },
+		{ "\\+", TokenType::Plus },
+		{ "-", TokenType::Minus },
+		{ "\\*/", TokenType::MultilineCommentEnd },
+		{ "\\*", TokenType::Star },
+		{ "/", TokenType::Division },
+		{ "%", TokenType::Modulo },
+		{ "\\^", TokenType::BitwiseXor },
+		{ "!", TokenType::BitwiseNot },
+		{ "&&", TokenType::LogicalAnd },
+		{ "\\|\\|", TokenType::LogicalOr },
+		{ "::", TokenType::ScopeOperator },
+		{ "->", TokenType::Arrow },
+		{ "\\+=", TokenType::PlusEqual },
+		{ "-=", TokenType::MinusEqual },
+		{ "\\*=", TokenType::StarEqual },
+		{ "/=", TokenType::DivideEqual },
+		{ "%=", TokenType::ModuloEqual }
+	});
+
+	return scanner;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "token.h"
+
+struct ScanRule {
+	const char* pattern;
+	TokenType type;
+};
+
+struct ScanResult {
+	bool matched;
+	TokenType type;
+	unsigned length;
+	unsigned examined; // bytes read before the automaton died, counting the end of input as one
+};
+
+// table-driven DFA compiled once from all token rules, earlier rules win like in Lexer::match_token
+class DfaScanner {
+	std::array<unsigned char, 256> byte_class;
+	unsigned class_count;
+
+	std::vector<int> transitions; // state * class_count + byte class, -1 is the dead state
+	std::vector<int> accepting_rule; // lowest rule index accepted in the state, -1 if none
+	std::vector<TokenType> rule_types;
+
+public:
+
+	DfaScanner(const std::vector<ScanRule>& rules);
+
+	ScanResult scan(const char* begin, const char* end) const;
+
+	unsigned state_count() const;
+
+	static const DfaScanner& lexer_rules();
+};
@@ -0,0 +1,95 @@
+#include "flat-ast.h"
+#include <iostream>
+
+FlatAST::FlatAST(AST* root) {
+	std::unordered_map<std::string_view, std::uint32_t> label_ids;
+
+	add_node(root, 0, label_ids);
+}
+
+FlatAST::NodeId FlatAST::add_node(AST* node, std::uint32_t depth, std::unordered_map<std::string_view, std::uint32_t>& label_ids) {
+	NodeId id = kinds.size();
+	auto root = node->get_root();
+
+	if (root.index() == 0) {
+		std::string_view label = std::get<std::string_view>(root);
+		auto it = label_ids.find(label);
+
+		if (it == label_ids.end()) {
+			it = label_ids.insert({ label, labels.size() }).first;
+			labels.push_back(label);
+		}
+
+		kinds.push_back(NodeKind::Label);
+		values.push_back(it->second);
+	}
+	else {
+		kinds.push_back(NodeKind::Token);
+		values.push_back(tokens.size());
+		tokens.push_back(std::get<Token>(root));
+	}
+
+	first_child.push_back(none);
+	next_sibling.push_back(none);
+	depths.push_back(depth);
+
+	NodeId previous = none;
+
+	for (size_t i = 0; i < node->child_count(); i++) {
+		NodeId child_id = add_node(node->get_child(i), depth + 1, label_ids);
+
+		if (previous == none) {
+			first_child[id] = child_id;
+		}
+		else {
+			next_sibling[previous] = child_id;
+		}
+		previous = child_id;
+	}
+
+	return id;
+}
+
+size_t FlatAST::size() const {
+	return kinds.size();
+}
+
+FlatAST::NodeId FlatAST::root() const {
+	return 0;
+}
+
+NodeKind FlatAST::kind(NodeId node) const {
+	return kinds[node];
+}
+
+std::string_view FlatAST::label(NodeId node) const {
+	return labels[values[node]];
+}
+
+const Token& FlatAST::token(NodeId node) const {
+	return tokens[values[node]];
+}
+
+std::uint32_t FlatAST::depth(NodeId node) const {
+	return depths[node];
+}
+
+FlatAST::ChildRange FlatAST::children(NodeId node) const {
+	return ChildRange{ ChildIterator(this, first_child[node]) };
+}
+
+// preorder storage means printing is a single linear pass
+void FlatAST::print(std::string_view source, const LineTable& lines, std::ostream& out) const {
+	for (NodeId i = 0; i < kinds.size(); i++) {
+		for (unsigned j = 0; j < depths[i]; j++) {
+			out << '\t';
+		}
+
+		if (kinds[i] == NodeKind::Label) {
+			out << labels[values[i]] << '\n';
+		}
+		else {
+			out << SourceToken{ tokens[values[i]], source, lines } << '\n';
+		}
+	}
+}
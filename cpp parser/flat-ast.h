@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "token.h"
+#include "ast-builder.h"
+#include "line-table.h"
+
+enum class NodeKind : std::uint8_t {
+	Label,
+	Token
+};
+
+// the tree stored as parallel arrays in preorder, node 0 is the root
+class FlatAST {
+public:
+	using NodeId = std::uint32_t;
+	static constexpr NodeId none = UINT32_MAX;
+
+	class ChildIterator {
+		const FlatAST* tree;
+		NodeId node;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = NodeId;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const NodeId*;
+		using reference = NodeId;
+
+		ChildIterator(const FlatAST* tree, NodeId node) : tree(tree), node(node) {}
+
+		NodeId operator*() const { return node; }
+		ChildIterator& operator++() { node = tree->next_sibling[node]; return *this; }
+		ChildIterator operator++(int) { ChildIterator old = *this; ++*this; return old; }
+
+		bool operator==(const ChildIterator& other) const { return node == other.node; }
+		bool operator!=(const ChildIterator& other) const { return node != other.node; }
+	};
+
+	struct ChildRange {
+		ChildIterator first;
+
+		ChildIterator begin() const { return first; }
+		ChildIterator end() const { return ChildIterator(nullptr, none); }
+	};
+
+private:
+	std::vector<NodeKind> kinds;
+	std::vector<std::uint32_t> values; // index into labels or tokens depending on the kind
+	std::vector<NodeId> first_child;
+	std::vector<NodeId> next_sibling;
+	std::vector<std::uint32_t> depths;
+
+	std::vector<std::string_view> labels;
+	std::vector<Token> tokens;
+
+	NodeId add_node(AST* node, std::uint32_t depth, std::unordered_map<std::string_view, std::uint32_t>& label_ids);
+
+public:
+
+	FlatAST(AST* root);
+
+	size_t size() const;
+	NodeId root() const;
+
+	NodeKind kind(NodeId node) const;
+	std::string_view label(NodeId node) const;
+	const Token& token(NodeId node) const;
+	std::uint32_t depth(NodeId node) const;
+
+	ChildRange children(NodeId node) const;
+
+	void print(std::string_view source, const LineTable& lines, std::ostream& out = std::cout) const;
+};
@@ -0,0 +1,272 @@
+#include "incremental-parser.h"
+#include "parser.h"
+#include "token-stream.h"
+#include <algorithm>
+#include <iterator>
+#include <ostream>
+
+void IncrementalParser::Shift::apply(Token& token) const {
+	// the placeholder the parser hands out at the end has no position to move
+	if (token.offset < from_offset || (token.type == TokenType::EndOfTokens && token.offset == 0)) {
+		return;
+	}
+
+	token.offset += offset_delta;
+}
+
+IncrementalParser::IncrementalParser(std::string text, LexerBackend backend) {
+	this->text = std::move(text);
+	this->backend = backend;
+
+	parse_all();
+}
+
+void IncrementalParser::parse_all() {
+	tokens.clear();
+	reach.clear();
+	lines = LineTable(text);
+
+	Lexer lexer(text.data(), text.size(), backend);
+	size_t furthest = 0;
+	Token token;
+
+	do {
+		token = lexer.next();
+		furthest = std::max(furthest, lexer.reach());
+
+		tokens.push_back(token);
+		reach.push_back(furthest);
+	} while (token.type != TokenType::EndOfTokens);
+
+	arena = std::make_unique<Arena>();
+
+	TraceSink discard;
+	TokenStream stream(tokens);
+	Parser parser(stream, text, lines, *arena, discard);
+
+	program = parser.make_ast("Program");
+	items.clear();
+
+	while (!parser.finished_parsing()) {
+		size_t first = stream.consumed();
+		size_t children = program->child_count();
+		size_t reported = parser.get_diagnostics().size();
+
+		parser.parse_top_level_item(program);
+
+		items.push_back(Item{ std::uint32_t(first), std::uint32_t(stream.consumed() - first),
+			std::uint32_t(children), std::uint32_t(program->child_count() - children),
+			std::vector<Diagnostic>(parser.get_diagnostics().begin() + reported, parser.get_diagnostics().end()) });
+	}
+
+	full_parse_bytes = arena->bytes_used();
+}
+
+// lexes from the last token that didn't look at the edit until a new token starts where an old one did
+// past the edit, from there on the old tokens are reused with their positions shifted
+size_t IncrementalParser::relex(const TextEdit& edit, Shift& shift, size_t& replaced_old, size_t& replaced_new) {
+	std::int64_t delta = std::int64_t(edit.inserted.size()) - std::int64_t(edit.removed);
+	size_t edit_end = edit.offset + edit.inserted.size();
+
+	text.replace(edit.offset, edit.removed, edit.inserted);
+	lines.apply_edit(edit.offset, edit.removed, edit.inserted);
+
+	size_t first = std::upper_bound(reach.begin(), reach.end(), edit.offset) - reach.begin();
+
+	unsigned offset = 0;
+	size_t furthest = 0;
+
+	if (first > 0) {
+		offset = tokens[first - 1].offset + tokens[first - 1].length;
+		furthest = reach[first - 1];
+	}
+
+	Lexer lexer(text.data(), text.size(), backend);
+	lexer.resume(offset);
+
+	TokenArray fresh_tokens;
+	std::vector<size_t> fresh_reach;
+
+	size_t old = first;
+	bool synced = false;
+	shift = Shift{ UINT32_MAX, 0 };
+
+	while (true) {
+		Token token = lexer.next();
+
+		if (token.type != TokenType::EndOfTokens && token.offset >= edit_end) {
+			size_t old_offset = token.offset - delta;
+
+			while (old < tokens.size() - 1 && tokens[old].offset < old_offset) {
+				old++;
+			}
+
+			if (old < tokens.size() - 1 && tokens[old].offset == old_offset) {
+				shift = Shift{ std::uint32_t(old_offset), delta };
+				synced = true;
+				break;
+			}
+		}
+
+		furthest = std::max(furthest, lexer.reach());
+		fresh_tokens.push_back(token);
+		fresh_reach.push_back(furthest);
+
+		if (token.type == TokenType::EndOfTokens) {
+			break;
+		}
+	}
+
+	if (!synced) {
+		old = tokens.size();
+	}
+
+	tokens.shift_offsets(old, shift.offset_delta);
+
+	for (size_t i = old; i < tokens.size(); i++) {
+		furthest = std::max(furthest, size_t(reach[i] + delta));
+		reach[i] = furthest;
+	}
+
+	tokens.replace(first, old, fresh_tokens);
+
+	reach.erase(reach.begin() + first, reach.begin() + old);
+	reach.insert(reach.begin() + first, fresh_reach.begin(), fresh_reach.end());
+
+	replaced_old = old - first;
+	replaced_new = fresh_tokens.size();
+
+	return first;
+}
+
+// the parser builds trees, no node is reachable twice
+void IncrementalParser::shift_tree(AST* tree, const Shift& shift) const {
+	Token* token = tree->get_token();
+
+	if (token != nullptr) {
+		shift.apply(*token);
+	}
+
+	for (size_t i = 0; i < tree->child_count(); i++) {
+		shift_tree(tree->get_child(i), shift);
+	}
+}
+
+void IncrementalParser::apply(const TextEdit& edit) {
+	Shift shift;
+	size_t replaced_old;
+	size_t replaced_new;
+
+	size_t first_token = relex(edit, shift, replaced_old, replaced_new);
+	std::int64_t token_delta = std::int64_t(replaced_new) - std::int64_t(replaced_old);
+
+	// an item depends on the tokens it consumed plus the lookahead window after them
+	size_t first_item = std::partition_point(items.begin(), items.end(), [&](const Item& item) {
+		return item.first_token + item.token_count + TokenStream::window_size <= first_token;
+	}) - items.begin();
+
+	size_t start_token = first_item < items.size() ? items[first_item].first_token : 0;
+	size_t start_child = first_item < items.size() ? items[first_item].first_child : 0;
+
+	TraceSink discard;
+	TokenStream stream(tokens, start_token);
+	Parser parser(stream, text, lines, *arena, discard);
+
+	AST* scratch = parser.make_ast("Program");
+	std::vector<Item> fresh_items;
+
+	// once an item would start on a reused token where an old item started, the old items from there on still hold
+	size_t reused_from = first_token + replaced_new;
+	size_t old_item = first_item;
+	bool synced = false;
+
+	while (!parser.finished_parsing()) {
+		size_t position = start_token + stream.consumed();
+
+		if (position >= reused_from) {
+			size_t old_position = position - token_delta;
+
+			while (old_item < items.size() && items[old_item].first_token < old_position) {
+				old_item++;
+			}
+
+			if (old_item < items.size() && items[old_item].first_token == old_position) {
+				synced = true;
+				break;
+			}
+		}
+
+		size_t children = scratch->child_count();
+		size_t reported = parser.get_diagnostics().size();
+
+		parser.parse_top_level_item(scratch);
+
+		fresh_items.push_back(Item{ std::uint32_t(position), std::uint32_t(start_token + stream.consumed() - position),
+			std::uint32_t(start_child + children), std::uint32_t(scratch->child_count() - children),
+			std::vector<Diagnostic>(parser.get_diagnostics().begin() + reported, parser.get_diagnostics().end()) });
+	}
+
+	if (!synced) {
+		old_item = items.size();
+	}
+
+	size_t old_children = 0;
+
+	for (size_t i = first_item; i < old_item; i++) {
+		old_children += items[i].child_count;
+	}
+
+	std::int64_t child_delta = std::int64_t(scratch->child_count()) - std::int64_t(old_children);
+
+	if (shift.offset_delta != 0) {
+		for (size_t i = start_child + old_children; i < program->child_count(); i++) {
+			shift_tree(program->get_child(i), shift);
+		}
+	}
+
+	for (size_t i = old_item; i < items.size(); i++) {
+		items[i].first_token += token_delta;
+		items[i].first_child += child_delta;
+
+		for (Diagnostic& diagnostic : items[i].diagnostics) {
+			shift.apply(diagnostic.token);
+		}
+	}
+
+	program->replace_children(start_child, old_children, scratch->get_children());
+
+	items.erase(items.begin() + first_item, items.begin() + old_item);
+	items.insert(items.begin() + first_item, std::make_move_iterator(fresh_items.begin()),
+		std::make_move_iterator(fresh_items.end()));
+
+	// replaced subtrees stay in the arena, start over once they outweigh the live tree
+	if (arena->bytes_used() > 2 * full_parse_bytes + 64 * 1024) {
+		parse_all();
+	}
+}
+
+AST* IncrementalParser::tree() const {
+	return program;
+}
+
+const TokenArray& IncrementalParser::get_tokens() const {
+	return tokens;
+}
+
+const LineTable& IncrementalParser::get_lines() const {
+	return lines;
+}
+
+std::string_view IncrementalParser::source() const {
+	return text;
+}
+
+std::vector<Diagnostic> IncrementalParser::get_diagnostics() const {
+	std::vector<Diagnostic> diagnostics;
+
+	for (const Item& item : items) {
+		diagnostics.insert(diagnostics.end(), item.diagnostics.begin(), item.diagnostics.end());
+	}
+
+	return diagnostics;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "lexer.h"
+#include "line-table.h"
+#include "ast-builder.h"
+#include "arena.h"
+#include "parse-result.h"
+
+struct TextEdit {
+	size_t offset;
+	size_t removed;
+	std::string inserted;
+};
+
+// keeps the tokens and tree of a file that is edited in place, after an edit only the tokens around it
+// are lexed again and only the top-level items that saw them are parsed again, the rest is reused
+// the result is the same tree a full parse would give, only the dfa backend knows how far each token looked
+// ahead, with the regex one every edit re-lexes from the start
+class IncrementalParser {
+	struct Item {
+		std::uint32_t first_token;
+		std::uint32_t token_count;
+		std::uint32_t first_child;
+		std::uint32_t child_count;
+		std::vector<Diagnostic> diagnostics; // what parsing the item reported
+	};
+
+	// how the offsets of the reused tokens after an edit move
+	struct Shift {
+		std::uint32_t from_offset;
+		std::int64_t offset_delta;
+
+		void apply(Token& token) const;
+	};
+
+	std::string text;
+	LineTable lines;
+	LexerBackend backend;
+
+	TokenArray tokens;
+	std::vector<size_t> reach; // running maximum of Lexer::reach after each token
+
+	std::vector<Item> items;
+
+	std::unique_ptr<Arena> arena;
+	AST* program;
+	size_t full_parse_bytes;
+
+	void parse_all();
+
+	size_t relex(const TextEdit& edit, Shift& shift, size_t& replaced_old, size_t& replaced_new);
+	void shift_tree(AST* tree, const Shift& shift) const;
+
+public:
+
+	IncrementalParser(std::string text, LexerBackend backend = LexerBackend::Dfa);
+
+	IncrementalParser(const IncrementalParser& other) = delete;
+	IncrementalParser& operator=(const IncrementalParser& other) = delete;
+
+	void apply(const TextEdit& edit);
+
+	AST* tree() const;
+	const TokenArray& get_tokens() const;
+	const LineTable& get_lines() const;
+	std::string_view source() const;
+
+	// the same ones Parser::get_diagnostics gives after a full parse of the current text
+	std::vector<Diagnostic> get_diagnostics() const;
+};
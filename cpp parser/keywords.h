@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "token.h"
+
+struct Keyword {
+	std::string_view text;
+	TokenType type;
+};
+
+// every word the lexer turns into something other than an Identifier
+constexpr Keyword keywords[] = {
+	{ "using", TokenType::Using },
+	{ "namespace", TokenType::Namespace },
+	{ "break", TokenType::Break },
+	{ "case", TokenType::Case },
+	{ "class", TokenType::Class },
+	{ "struct", TokenType::Struct },
+	{ "int", TokenType::IntegerType },
+	{ "signed", TokenType::IntegerType },
+	{ "short", TokenType::IntegerType },
+	{ "long", TokenType::IntegerType },
+	{ "double", TokenType::FloatType },
+	{ "float", TokenType::FloatType },
+	{ "string", TokenType::String },
+	{ "char", TokenType::Char },
+	{ "unsigned", TokenType::Unsigned },
+	{ "bool", TokenType::Bool },
+	{ "new", TokenType::New },
+	{ "public", TokenType::AccessSpecifier },
+	{ "private", TokenType::AccessSpecifier },
+	{ "protected", TokenType::AccessSpecifier },
+	{ "if", TokenType::If },
+	{ "else", TokenType::Else },
+	{ "true", TokenType::True },
+	{ "false", TokenType::False },
+	{ "return", TokenType::Return },
+	{ "while", TokenType::While },
+	{ "for", TokenType::For },
+	{ "do", TokenType::Do },
+	{ "const", TokenType::Const },
+	{ "void", TokenType::Void },
+	{ "cin", TokenType::Cin },
+	{ "cout", TokenType::Cout }
+};
+
+constexpr unsigned keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+
+// perfect hash over the keyword set: the length and the first, second and last characters are packed
+// into one word, which is multiplied by a seed found at compile time and its top bits pick the slot
+class KeywordTable {
+	static constexpr unsigned slot_bits = 7;
+	static constexpr unsigned slot_count = 1 << slot_bits;
+
+	std::uint32_t seed;
+	std::array<std::int8_t, slot_count> slots;
+
+	static constexpr std::uint32_t key(std::string_view word) {
+		return std::uint32_t(static_cast<unsigned char>(word[0]))
+			| std::uint32_t(static_cast<unsigned char>(word[1 % word.size()])) << 8
+			| std::uint32_t(static_cast<unsigned char>(word[word.size() - 1])) << 16
+			| std::uint32_t(word.size() & 0xff) << 24;
+	}
+
+	static constexpr unsigned slot(std::uint32_t key, std::uint32_t seed) {
+		return std::uint32_t(key * seed) >> (32 - slot_bits);
+	}
+
+	constexpr bool try_seed(std::uint32_t candidate) {
+		for (std::int8_t& entry : slots) {
+			entry = -1;
+		}
+
+		for (unsigned i = 0; i < keyword_count; i++) {
+			std::int8_t& entry = slots[slot(key(keywords[i].text), candidate)];
+
+			if (entry != -1) {
+				return false;
+			}
+			entry = i;
+		}
+
+		seed = candidate;
+		return true;
+	}
+
+public:
+
+	constexpr KeywordTable() : seed(0), slots() {
+		for (std::uint32_t candidate = 0x9e3779b1; !try_seed(candidate); candidate += 2) {}
+	}
+
+	// Identifier unless the whole word is a keyword, the word must not be empty
+	constexpr TokenType classify(std::string_view word) const {
+		std::int8_t entry = slots[slot(key(word), seed)];
+
+		if (entry != -1 && keywords[entry].text == word) {
+			return keywords[entry].type;
+		}
+
+		return TokenType::Identifier;
+	}
+};
+
+constexpr KeywordTable keyword_table;
+
+static_assert(keyword_table.classify("while") == TokenType::While, "keyword table is broken");
+static_assert(keyword_table.classify("intx") == TokenType::Identifier, "keyword table is broken");
@@ -0,0 +1,87 @@
+#include "lexer-stats.h"
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <string_view>
+
+namespace {
+
+	std::mutex names_mutex;
+
+	std::vector<const char*>& rule_names() {
+		static std::vector<const char*> names;
+		return names;
+	}
+
+	const char* name_of(size_t id) {
+		std::lock_guard<std::mutex> lock(names_mutex);
+		return rule_names()[id];
+	}
+
+	std::vector<size_t> tried_by_time(const std::vector<RuleStats>& rules) {
+		std::vector<size_t> order;
+
+		for (size_t id = 0; id < rules.size(); id++) {
+			if (rules[id].tried > 0) {
+				order.push_back(id);
+			}
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return rules[a].time > rules[b].time;
+		});
+
+		return order;
+	}
+}
+
+size_t LexerStats::rule_id(const char* name) {
+	std::lock_guard<std::mutex> lock(names_mutex);
+	std::vector<const char*>& names = rule_names();
+
+	for (size_t id = 0; id < names.size(); id++) {
+		if (std::string_view(names[id]) == name) {
+			return id;
+		}
+	}
+
+	names.push_back(name);
+	return names.size() - 1;
+}
+
+RuleStats& LexerStats::of(size_t id) {
+	if (id >= rules.size()) {
+		rules.resize(id + 1);
+	}
+
+	return rules[id];
+}
+
+void LexerStats::print(std::ostream& out) const {
+	RuleStats total;
+
+	out << std::left << std::setw(24) << "rule" << std::right
+		<< std::setw(12) << "tried" << std::setw(12) << "matched" << std::setw(12) << "failed"
+		<< std::setw(12) << "bytes" << std::setw(12) << "ms" << std::setw(10) << "ns/try" << '\n';
+
+	for (size_t id : tried_by_time(rules)) {
+		const RuleStats& rule = rules[id];
+
+		out << std::left << std::setw(24) << name_of(id) << std::right
+			<< std::setw(12) << rule.tried << std::setw(12) << rule.matched << std::setw(12) << rule.tried - rule.matched
+			<< std::setw(12) << rule.bytes << std::setw(12) << std::fixed << std::setprecision(3) << rule.time.count() / 1e6
+			<< std::setw(10) << std::setprecision(1) << double(rule.time.count()) / rule.tried << '\n';
+
+		total.tried += rule.tried;
+		total.matched += rule.matched;
+		total.bytes += rule.bytes;
+		total.time += rule.time;
+	}
+
+	out << std::left << std::setw(24) << "total" << std::right
+		<< std::setw(12) << total.tried << std::setw(12) << total.matched << std::setw(12) << total.tried - total.matched
+		<< std::setw(12) << total.bytes << std::setw(12) << std::fixed << std::setprecision(3) << total.time.count() / 1e6
+		<< '\n';
+
+	out << std::defaultfloat;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// built with LEXER_STATS defined, the lexer counts and times every rule it tries and prints a table to
+// std::cerr at the end of produce_tokens, without it the rules are called directly and nothing is kept
+#ifdef LEXER_STATS
+constexpr bool lexer_stats_enabled = true;
+#else
+constexpr bool lexer_stats_enabled = false;
+#endif
+
+struct RuleStats {
+	std::uint64_t tried = 0;
+	std::uint64_t matched = 0;
+	std::uint64_t bytes = 0; // taken off the input by the matches
+	std::chrono::nanoseconds time{ 0 };
+};
+
+class LexerStats {
+	std::vector<RuleStats> rules;
+
+public:
+
+	// one id per rule name for the whole program, safe to call from several lexers at once
+	static size_t rule_id(const char* name);
+
+	RuleStats& of(size_t id);
+
+	// rules that were never tried are left out, the slowest come first
+	void print(std::ostream& out) const;
+};
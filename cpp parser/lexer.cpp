@@ -1,117 +1,145 @@
 #include "lexer.h"
 #include "utility_funcs.h"
+#include "dfa-scanner.h"
+#include "keywords.h"
+#include "char-scan.h"
+#include "numeric-literal.h"
 #include <regex>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
 
-Lexer::Lexer(std::string content) {
-	raw_content = content;
-	line = 1;
-	column = 1;
+Lexer::Lexer(std::string content, LexerBackend backend) {
+	owned_content = std::move(content);
+	raw_content = owned_content;
+	cursor = raw_content;
+	has_pending = false;
+	furthest = 0;
+	keep_comments = true;
+	limit = std::string_view::npos;
+	this->backend = backend;
 }
 
-void Lexer::print_tokens() const {
-	for (Token t : tokens) {
-		std::cout << t << '\n';
-	}
+Lexer::Lexer(const char* data, size_t size, LexerBackend backend) {
+	raw_content = std::string_view(data, size);
+	cursor = raw_content;
+	has_pending = false;
+	furthest = 0;
+	keep_comments = true;
+	limit = std::string_view::npos;
+	this->backend = backend;
 }
 
-void Lexer::remove_whitespaces_at_start(std::string& str) {
-	int i = 0;
-	
-	while (!str.empty() && str[i] == ' ') {
-		column++;
-		i++;
-	}
+void Lexer::print_tokens(std::ostream& out) const {
+	::print_tokens(tokens.columns(), raw_content, lines, out);
+}
+
+std::string_view Lexer::source() const {
+	return raw_content;
+}
 
-	str = str.substr(i, std::string::npos);
+const LexerStats& Lexer::get_stats() const {
+	return stats;
 }
 
-bool Lexer::match_using(std::string& content) {
-	std::regex rgx("using");
-	std::smatch it;
+unsigned Lexer::offset_of(std::string_view content) const {
+	return content.data() - raw_content.data();
+}
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-		
-		tokens.push_back(Token(TokenType::Using, it.str(),line,column,len));
-		column = column + len;
+// takes the line breaks too, a '\r' only counts as one when a '\n' follows it
+void Lexer::remove_whitespaces_at_start(std::string_view& str) {
+	const char* begin = str.data();
+	size_t run = span_blanks(begin, begin + str.size());
 
-		content = it.suffix();
-		return true;
+	const char* carriage_return = static_cast<const char*>(std::memchr(begin, '\r', run));
+
+	while (carriage_return != nullptr) {
+		size_t position = carriage_return - begin;
+
+		if (position + 1 == run || begin[position + 1] != '\n') {
+			run = position;
+			break;
+		}
+
+		carriage_return = static_cast<const char*>(std::memchr(begin + position + 1, '\r', run - position - 1));
 	}
 
-	return false;
+	move_over(str.substr(0, run));
+	str.remove_prefix(run);
 }
 
-bool Lexer::match_namespace(std::string& content) {
-	std::regex rgx("namespace");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+// notes where the lines inside text start, text can be anything the lexer steps over
+void Lexer::move_over(std::string_view text) {
+	const char* begin = text.data();
+	const char* end = begin + text.size();
 
-		tokens.push_back(Token(TokenType::Namespace, it.str(),line,column,len));
-		column = column + len;
+	for (const char* newline = static_cast<const char*>(std::memchr(begin, '\n', text.size())); newline != nullptr;
+		newline = static_cast<const char*>(std::memchr(newline + 1, '\n', end - newline - 1))) {
+		lines.add_line(newline + 1 - raw_content.data());
+	}
+}
 
-		content = it.suffix();
-		return true;
+void Lexer::emit_comment(Token token) {
+	if (keep_comments) {
+		emit(token);
 	}
+}
 
-	return false;
+void Lexer::set_keep_comments(bool keep) {
+	keep_comments = keep;
 }
 
-bool Lexer::match_newline(std::string& content) {
-	std::regex rgx("\n");
-	std::smatch it;
+bool Lexer::match_newline(std::string_view& content) {
+	std::regex rgx("\r?\n");
+	std::cmatch it;
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
 		/*
-		unsigned len = it.str().length();
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::NewLine, it.str(),line,column,len));
+		emit(Token(TokenType::NewLine, offset_of(content), len));
 		*/
 
-		line++;
-		column = 1;
+		lines.add_line(offset_of(content) + it.length());
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_plus_equal(std::string& content) {
+bool Lexer::match_plus_equal(std::string_view& content) {
 	std::regex rgx("\\+=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::PlusEqual,it.str(),line,column,len));
-		column = column + len;
+		emit(Token(TokenType::PlusEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_minus_equal(std::string& content) {
+bool Lexer::match_minus_equal(std::string_view& content) {
 	std::regex rgx("-=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::MinusEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::MinusEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -119,18 +147,17 @@ bool Lexer::match_minus_equal(std::string& content) {
 
 }
 
-bool Lexer::match_star_equal(std::string& content) {
+bool Lexer::match_star_equal(std::string_view& content) {
 	std::regex rgx("\\*=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::StarEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::StarEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -138,18 +165,17 @@ bool Lexer::match_star_equal(std::string& content) {
 
 }
 
-bool Lexer::match_divide_equal(std::string& content) {
+bool Lexer::match_divide_equal(std::string_view& content) {
 	std::regex rgx("/=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::DivideEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::DivideEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -157,18 +183,17 @@ bool Lexer::match_divide_equal(std::string& content) {
 
 }
 
-bool Lexer::match_modulo_equal(std::string& content) {
+bool Lexer::match_modulo_equal(std::string_view& content) {
 	std::regex rgx("%=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::ModuloEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::ModuloEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -176,18 +201,17 @@ bool Lexer::match_modulo_equal(std::string& content) {
 
 }
 
-bool Lexer::match_left_shift_equal(std::string& content) {
+bool Lexer::match_left_shift_equal(std::string_view& content) {
 	std::regex rgx("<<=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LeftShiftEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LeftShiftEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -195,18 +219,17 @@ bool Lexer::match_left_shift_equal(std::string& content) {
 
 }
 
-bool Lexer::match_right_shift_equal(std::string& content) {
+bool Lexer::match_right_shift_equal(std::string_view& content) {
 	std::regex rgx(">>=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::RightShiftEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::RightShiftEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -214,18 +237,17 @@ bool Lexer::match_right_shift_equal(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_and_equal(std::string& content) {
+bool Lexer::match_bitwise_and_equal(std::string_view& content) {
 	std::regex rgx("&=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseAndEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseAndEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -233,18 +255,17 @@ bool Lexer::match_bitwise_and_equal(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_or_equal(std::string& content) {
+bool Lexer::match_bitwise_or_equal(std::string_view& content) {
 	std::regex rgx("\|=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseOrEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseOrEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -252,18 +273,17 @@ bool Lexer::match_bitwise_or_equal(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_xor_equal(std::string& content) {
+bool Lexer::match_bitwise_xor_equal(std::string_view& content) {
 	std::regex rgx("\^=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseXorEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseXorEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -271,18 +291,17 @@ bool Lexer::match_bitwise_xor_equal(std::string& content) {
 
 }
 
-bool Lexer::match_scope_operator(std::string& content) {
+bool Lexer::match_scope_operator(std::string_view& content) {
 	std::regex rgx("::");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::ScopeOperator, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::ScopeOperator, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -290,18 +309,17 @@ bool Lexer::match_scope_operator(std::string& content) {
 
 }
 
-bool Lexer::match_arrow(std::string& content) {
+bool Lexer::match_arrow(std::string_view& content) {
 	std::regex rgx("->");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Arrow, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Arrow, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -309,18 +327,17 @@ bool Lexer::match_arrow(std::string& content) {
 
 }
 
-bool Lexer::match_plus_plus(std::string& content) {
+bool Lexer::match_plus_plus(std::string_view& content) {
 	std::regex rgx("\\+\\+");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::PlusPlus, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::PlusPlus, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -328,18 +345,17 @@ bool Lexer::match_plus_plus(std::string& content) {
 
 }
 
-bool Lexer::match_minus_minus(std::string& content) {
+bool Lexer::match_minus_minus(std::string_view& content) {
 	std::regex rgx("--");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::MinusMinus, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::MinusMinus, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -347,18 +363,17 @@ bool Lexer::match_minus_minus(std::string& content) {
 
 }
 
-bool Lexer::match_plus(std::string& content) {
+bool Lexer::match_plus(std::string_view& content) {
 	std::regex rgx("\\+");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Plus, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Plus, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -366,18 +381,17 @@ bool Lexer::match_plus(std::string& content) {
 
 }
 
-bool Lexer::match_star(std::string& content) {
+bool Lexer::match_star(std::string_view& content) {
 	std::regex rgx("\\*");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Star, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Star, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -385,18 +399,17 @@ bool Lexer::match_star(std::string& content) {
 
 }
 
-bool Lexer::match_minus(std::string& content) {
+bool Lexer::match_minus(std::string_view& content) {
 	std::regex rgx("-");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Minus, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Minus, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -404,18 +417,17 @@ bool Lexer::match_minus(std::string& content) {
 
 }
 
-bool Lexer::match_modulo(std::string& content) {
+bool Lexer::match_modulo(std::string_view& content) {
 	std::regex rgx("%");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Modulo, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Modulo, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -423,54 +435,56 @@ bool Lexer::match_modulo(std::string& content) {
 
 }
 
-bool Lexer::match_line_comment(std::string& content) {
-	std::regex rgx("//");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+// up to the end of the line, the line break itself is left to the blank skip
+bool Lexer::match_line_comment(std::string_view& content) {
+	if (content.size() < 2 || content[0] != '/' || content[1] != '/') {
+		return false;
+	}
 
-		tokens.push_back(Token(TokenType::LineComment, it.str(), line, column, len));
-		column = column + len;
+	const char* newline = static_cast<const char*>(std::memchr(content.data(), '\n', content.size()));
+	size_t scanned = newline == nullptr ? content.size() : newline - content.data();
+	size_t len = scanned;
 
-		content = it.suffix();
-		return true;
+	if (len > 2 && content[len - 1] == '\r') {
+		len--;
 	}
 
-	return false;
-}
-
-bool Lexer::match_multiline_comment_start(std::string& content) {
-	std::regex rgx("/\\*");
-	std::smatch it;
+	furthest = std::max(furthest, offset_of(content) + scanned + 1);
+	emit_comment(Token(TokenType::LineComment, offset_of(content), len));
 
+	content.remove_prefix(len);
+	return true;
+}
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+// up to and including the first */, an unclosed comment takes the rest of the input
+bool Lexer::match_multiline_comment(std::string_view& content) {
+	if (content.size() < 2 || content[0] != '/' || content[1] != '*') {
+		return false;
+	}
 
-		tokens.push_back(Token(TokenType::MultilineCommentStart, it.str(), line, column, len));
-		column = column + len;
+	const char* end = content.data() + content.size();
+	size_t body = find_pair(content.data() + 2, end, '*', '/');
+	size_t len = body == content.size() - 2 ? content.size() : body + 4;
 
-		content = it.suffix();
-		return true;
-	}
+	furthest = std::max(furthest, offset_of(content) + (len == content.size() ? len + 1 : len));
+	emit_comment(Token(TokenType::MultilineComment, offset_of(content), len));
+	move_over(content.substr(0, len));
 
-	return false;
+	content.remove_prefix(len);
+	return true;
 }
 
-bool Lexer::match_multiline_comment_end(std::string& content) {
+bool Lexer::match_multiline_comment_end(std::string_view& content) {
 	std::regex rgx("\\*/");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::MultilineCommentEnd, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::MultilineCommentEnd, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -478,18 +492,17 @@ bool Lexer::match_multiline_comment_end(std::string& content) {
 }
 
 
-bool Lexer::match_division(std::string& content) {
+bool Lexer::match_division(std::string_view& content) {
 	std::regex rgx("/");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Division, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Division, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -497,18 +510,17 @@ bool Lexer::match_division(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_xor(std::string& content) {
+bool Lexer::match_bitwise_xor(std::string_view& content) {
 	std::regex rgx("\\^");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseXor, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseXor, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -516,18 +528,17 @@ bool Lexer::match_bitwise_xor(std::string& content) {
 
 }
 
-bool Lexer::match_left_shift(std::string& content) {
+bool Lexer::match_left_shift(std::string_view& content) {
 	std::regex rgx("<<");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LeftShift, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LeftShift, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -535,18 +546,17 @@ bool Lexer::match_left_shift(std::string& content) {
 
 }
 
-bool Lexer::match_right_shift(std::string& content) {
+bool Lexer::match_right_shift(std::string_view& content) {
 	std::regex rgx(">>");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::RightShift, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::RightShift, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -554,18 +564,17 @@ bool Lexer::match_right_shift(std::string& content) {
 
 }
 
-bool Lexer::match_less_equal(std::string& content) {
+bool Lexer::match_less_equal(std::string_view& content) {
 	std::regex rgx("<=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LessEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LessEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -573,18 +582,17 @@ bool Lexer::match_less_equal(std::string& content) {
 
 }
 
-bool Lexer::match_greater_equal(std::string& content) {
+bool Lexer::match_greater_equal(std::string_view& content) {
 	std::regex rgx(">=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::GreaterEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::GreaterEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -592,18 +600,17 @@ bool Lexer::match_greater_equal(std::string& content) {
 
 }
 
-bool Lexer::match_equal_equal(std::string& content) {
+bool Lexer::match_equal_equal(std::string_view& content) {
 	std::regex rgx("==");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::EqualEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::EqualEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -611,18 +618,17 @@ bool Lexer::match_equal_equal(std::string& content) {
 
 }
 
-bool Lexer::match_not_equal(std::string& content) {
+bool Lexer::match_not_equal(std::string_view& content) {
 	std::regex rgx("!=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::NotEqual, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::NotEqual, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -630,18 +636,17 @@ bool Lexer::match_not_equal(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_and(std::string& content) {
+bool Lexer::match_bitwise_and(std::string_view& content) {
 	std::regex rgx("&");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseAnd, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseAnd, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -649,18 +654,17 @@ bool Lexer::match_bitwise_and(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_or(std::string& content) {
+bool Lexer::match_bitwise_or(std::string_view& content) {
 	std::regex rgx("\\|");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseOr, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseOr, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -668,18 +672,17 @@ bool Lexer::match_bitwise_or(std::string& content) {
 
 }
 
-bool Lexer::match_bitwise_not(std::string& content) {
+bool Lexer::match_bitwise_not(std::string_view& content) {
 	std::regex rgx("!");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BitwiseNot, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BitwiseNot, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -687,18 +690,17 @@ bool Lexer::match_bitwise_not(std::string& content) {
 
 }
 
-bool Lexer::match_logical_and(std::string& content) {
+bool Lexer::match_logical_and(std::string_view& content) {
 	std::regex rgx("&&");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LogicalAnd, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LogicalAnd, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -706,18 +708,17 @@ bool Lexer::match_logical_and(std::string& content) {
 
 }
 
-bool Lexer::match_logical_or(std::string& content) {
+bool Lexer::match_logical_or(std::string_view& content) {
 	std::regex rgx("\\|\\|");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LogicalOr, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LogicalOr, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -726,18 +727,17 @@ bool Lexer::match_logical_or(std::string& content) {
 }
 
 
-bool Lexer::match_equal(std::string& content) {
+bool Lexer::match_equal(std::string_view& content) {
 	std::regex rgx("=");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Equal, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Equal, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -745,18 +745,17 @@ bool Lexer::match_equal(std::string& content) {
 
 }
 
-bool Lexer::match_less(std::string& content) {
+bool Lexer::match_less(std::string_view& content) {
 	std::regex rgx("<");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Less, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Less, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -764,18 +763,17 @@ bool Lexer::match_less(std::string& content) {
 
 }
 
-bool Lexer::match_greater(std::string& content) {
+bool Lexer::match_greater(std::string_view& content) {
 	std::regex rgx(">");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Greater, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Greater, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -783,214 +781,215 @@ bool Lexer::match_greater(std::string& content) {
 
 }
 
-bool Lexer::match_include_directive(std::string& content) {
+bool Lexer::match_include_directive(std::string_view& content) {
 	std::regex rgx("#include");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::IncludeDirective, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::IncludeDirective, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_header(std::string& content) {
-	std::regex rgx(R"(".+\.h")");
-	std::smatch it;
+// the longest ".+\.h" is the last .h" on the line with at least one character after the opening quote
+bool Lexer::match_header(std::string_view& content) {
+	if (content.empty() || content[0] != '"') {
+		return false;
+	}
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	const char* begin = content.data();
+	const char* newline = static_cast<const char*>(std::memchr(begin, '\n', content.size()));
+	size_t line_end = newline == nullptr ? content.size() : newline - begin;
+	const char* carriage_return = static_cast<const char*>(std::memchr(begin, '\r', line_end));
 
-		tokens.push_back(Token(TokenType::Header, it.str(), line, column, len));
-		column = column + len;
+	if (carriage_return != nullptr) {
+		line_end = carriage_return - begin;
+	}
 
-		content = it.suffix();
-		return true;
+	furthest = std::max(furthest, offset_of(content) + line_end + 1);
+
+	for (size_t close = line_end; close-- > 4;) {
+		if (content[close] == '"' && content[close - 1] == 'h' && content[close - 2] == '.') {
+			emit(Token(TokenType::Header, offset_of(content), close + 1));
+
+			content.remove_prefix(close + 1);
+			return true;
+		}
 	}
 
 	return false;
 }
 
-bool Lexer::match_left_paren(std::string& content) {
+bool Lexer::match_left_paren(std::string_view& content) {
 	std::regex rgx("\\(");
-	std::smatch it;
+	std::cmatch it;
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LeftParen, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LeftParen, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_right_paren(std::string& content) {
+bool Lexer::match_right_paren(std::string_view& content) {
 	std::regex rgx("\\)");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::RightParen, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::RightParen, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_left_brace(std::string& content) {
+bool Lexer::match_left_brace(std::string_view& content) {
 	std::regex rgx("\\{");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::LeftBrace, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::LeftBrace, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_right_brace(std::string& content) {
+bool Lexer::match_right_brace(std::string_view& content) {
 	std::regex rgx("\\}");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::RightBrace, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::RightBrace, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_colon(std::string& content) {
+bool Lexer::match_colon(std::string_view& content) {
 	std::regex rgx(":");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Colon, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Colon, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_semicolon(std::string& content) {
+bool Lexer::match_semicolon(std::string_view& content) {
 	std::regex rgx(";");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Semicolon, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Semicolon, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_comma(std::string& content) {
+bool Lexer::match_comma(std::string_view& content) {
 	std::regex rgx(",");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Comma, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Comma, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_dot_operator(std::string& content) {
+bool Lexer::match_dot_operator(std::string_view& content) {
 	std::regex rgx("\\.");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::DotOperator, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::DotOperator, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_tilde(std::string& content) {
+bool Lexer::match_tilde(std::string_view& content) {
 	std::regex rgx("~");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::Tilde, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Tilde, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_bracket_operator(std::string& content) {
+bool Lexer::match_bracket_operator(std::string_view& content) {
 	std::regex rgx("\\[\\]|\\[(0|[1-9][0-9]*)\\]");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::BracketOperator, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::BracketOperator, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
@@ -998,827 +997,476 @@ bool Lexer::match_bracket_operator(std::string& content) {
 }
 
 
-bool Lexer::match_unsigned_constant(std::string& content) {
+bool Lexer::match_unsigned_constant(std::string_view& content) {
 	std::regex rgx("[0]|[1-9][0-9]*");
-	std::smatch it;
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::UnsignedConst, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::UnsignedConst, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_int_constant(std::string& content) {
-	std::regex rgx("[0]|[-+]?[1-9][0-9]*");
-	std::smatch it;
+bool Lexer::match_int_constant(std::string_view& content) {
+	std::regex rgx("0[xX][0-9a-fA-F]+('[0-9a-fA-F]+)*|0[bB][01]+('[01]+)*|[0]|[-+]?[1-9][0-9]*('[0-9]+)*");
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::IntConst, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::IntConst, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_float_constant(std::string& content) {
-	std::regex rgx("[+-]?([0]|[1-9]*)?[.][0-9]+");
-	std::smatch it;
+bool Lexer::match_float_constant(std::string_view& content) {
+	std::regex rgx("[+-]?([0-9]+('[0-9]+)*)?[.][0-9]+('[0-9]+)*([eE][+-]?[0-9]+)?|[+-]?[0-9]+('[0-9]+)*[eE][+-]?[0-9]+");
+	std::cmatch it;
 
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::FloatConst, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::FloatConst, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_char_constant(std::string& content) {
+bool Lexer::match_char_constant(std::string_view& content) {
 	std::regex rgx(R"('[^'\\]'|'\\a'|'\\b'|'\\f'|'\\n'|'\\r'|'\\t'|'\\v'|'\\''|'\\\\'|'\\"'|'\\?')");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	std::cmatch it;
 
-		tokens.push_back(Token(TokenType::CharConst, it.str(), line, column, len));
-		column = column + len;
 
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-bool Lexer::match_string_constant(std::string& content) {
-	std::regex rgx(R"("[^"]*")");
-	std::smatch it;
+		emit(Token(TokenType::CharConst, offset_of(content), len));
 
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::StringConst, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_identifier(std::string& content) {
-	std::regex rgx("[a-zA-Z_][a-zA-Z0-9_]*");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Identifier, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_break(std::string& content) {
-	std::regex rgx("break");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Break, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
+// nothing is escaped inside, so the literal ends at the next quote, even on a later line
+bool Lexer::match_string_constant(std::string_view& content) {
+	if (content.empty() || content[0] != '"') {
+		return false;
 	}
 
-	return false;
-}
-
-bool Lexer::match_case(std::string& content) {
-	std::regex rgx("case");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Case, it.str(), line, column, len));
-		column = column + len;
+	const char* close = static_cast<const char*>(std::memchr(content.data() + 1, '"', content.size() - 1));
 
-		content = it.suffix();
-		return true;
+	if (close == nullptr) {
+		furthest = std::max(furthest, offset_of(content) + content.size() + 1);
+		return false;
 	}
 
-	return false;
-}
-
-bool Lexer::match_class(std::string& content) {
-	std::regex rgx("class|struct");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		if (it.str() == "class") {
-			unsigned len = it.str().length();
-
-			tokens.push_back(Token(TokenType::Class, it.str(), line, column, len));
-			column = column + len;
-
-		}
-		else {
-			unsigned len = it.str().length();
-
-			tokens.push_back(Token(TokenType::Struct, it.str(), line, column, len));
-			column = column + len;
+	size_t len = close - content.data() + 1;
 
-		}
-		content = it.suffix();
-		return true;
-	}
+	furthest = std::max(furthest, offset_of(content) + len);
+	emit(Token(TokenType::StringConst, offset_of(content), len));
+	move_over(content.substr(0, len));
 
-	return false;
+	content.remove_prefix(len);
+	return true;
 }
 
-bool Lexer::match_delete(std::string& content) {
+bool Lexer::match_delete(std::string_view& content) {
 	std::regex rgx("delete");
-	std::smatch it;
-
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Delete, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_integer_type(std::string& content) {
-	std::regex rgx("int|signed|short|long");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::IntegerType, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
+	std::cmatch it;
 
-bool Lexer::match_float_type(std::string& content) {
-	std::regex rgx("double|float");
-	std::smatch it;
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	if (std::regex_search(content.data(), content.data() + content.size(), it, rgx, std::regex_constants::match_continuous)) {
+		unsigned len = it.length();
 
-		tokens.push_back(Token(TokenType::FloatType, it.str(), line, column, len));
-		column = column + len;
+		emit(Token(TokenType::Delete, offset_of(content), len));
 
-		content = it.suffix();
+		content.remove_prefix(it.length());
 		return true;
 	}
 
 	return false;
 }
 
-bool Lexer::match_string_type(std::string& content) {
-	std::regex rgx("string");
-	std::smatch it;
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+namespace {
 
-		tokens.push_back(Token(TokenType::String, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
+	bool is_word_start(char c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 	}
-
-	return false;
 }
 
-bool Lexer::match_char_type(std::string& content) {
-	std::regex rgx("char");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Char, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
+// the whole word is taken before looking it up, so "intx" is one Identifier and not int followed by x
+bool Lexer::match_word(std::string_view& content) {
+	if (content.empty() || !is_word_start(content[0])) {
+		return false;
 	}
 
-	return false;
-}
+	size_t len = 1 + span_word_chars(content.data() + 1, content.data() + content.size());
 
-bool Lexer::match_unsigned_type(std::string& content) {
-	std::regex rgx("unsigned");
-	std::smatch it;
+	// the character after the word was read too
+	furthest = std::max(furthest, offset_of(content) + len + 1);
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Unsigned, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
+	emit(Token(keyword_table.classify(content.substr(0, len)), offset_of(content), len));
 
-	return false;
+	content.remove_prefix(len);
+	return true;
 }
 
-bool Lexer::match_bool_type(std::string& content) {
-	std::regex rgx("bool");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Bool, it.str(), line, column, len));
-		column = column + len;
+// numbers that start with a digit, the rules are only needed for the signed ones and those starting with a .
+bool Lexer::match_digits(std::string_view& content) {
+	NumericScan number = scan_numeric_literal(content);
 
-		content = it.suffix();
-		return true;
+	if (!number.matched) {
+		return false;
 	}
 
-	return false;
-}
-
-bool Lexer::match_new(std::string& content) {
-	std::regex rgx("new");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+	furthest = std::max(furthest, offset_of(content) + number.examined);
 
-		tokens.push_back(Token(TokenType::New, it.str(), line, column, len));
-		column = column + len;
+	emit(Token(number.type, offset_of(content), number.length));
 
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
+	content.remove_prefix(number.length);
+	return true;
 }
 
-bool Lexer::match_access_specifier(std::string& content) {
-	std::regex rgx("public|private|protected");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::AccessSpecifier, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
+// without LEXER_STATS this is just the call
+template <bool (Lexer::*rule)(std::string_view&)>
+bool Lexer::try_rule(const char* name, std::string_view& content) {
+	if constexpr (!lexer_stats_enabled) {
+		return (this->*rule)(content);
 	}
+	else {
+		static const size_t id = LexerStats::rule_id(name);
 
-	return false;
-}
-
-bool Lexer::match_if(std::string& content) {
-	std::regex rgx("if");
-	std::smatch it;
+		size_t before = content.size();
+		auto start = std::chrono::steady_clock::now();
 
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
+		bool matched = (this->*rule)(content);
 
-		tokens.push_back(Token(TokenType::If, it.str(), line, column, len));
-		column = column + len;
+		RuleStats& rule_stats = stats.of(id);
+		rule_stats.time += std::chrono::steady_clock::now() - start;
+		rule_stats.tried++;
+		rule_stats.matched += matched;
+		rule_stats.bytes += before - content.size();
 
-		content = it.suffix();
-		return true;
+		return matched;
 	}
-
-	return false;
 }
 
-bool Lexer::match_else(std::string& content) {
-	std::regex rgx("else");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Else, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
+// words, numbers, quotes and comments are told apart by their first characters, no other rule can take those
+bool Lexer::match_fast_path(std::string_view& content) {
+	return try_rule<&Lexer::match_word>("word", content)
+		|| try_rule<&Lexer::match_digits>("digits", content)
+		|| try_rule<&Lexer::match_header>("header", content)
+		|| try_rule<&Lexer::match_string_constant>("string_constant", content)
+		|| try_rule<&Lexer::match_multiline_comment>("multiline_comment", content)
+		|| try_rule<&Lexer::match_line_comment>("line_comment", content);
 }
 
-bool Lexer::match_bool_value(std::string& content) {
-	std::regex rgx("true|false");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		if (it.str() == "true") {
-			unsigned len = it.str().length();
-
-			tokens.push_back(Token(TokenType::True, it.str(), line, column, len));
-			column = column + len;
-
-		}
-		else {
-			unsigned len = it.str().length();
-
-			tokens.push_back(Token(TokenType::False, it.str(), line, column, len));
-			column = column + len;
-
-		}
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_return(std::string& content) {
-	std::regex rgx("return");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Return, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_while(std::string& content) {
-	std::regex rgx("while");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::While, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_for(std::string& content) {
-	std::regex rgx("for");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::For, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_do(std::string& content) {
-	std::regex rgx("do");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Do, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_const(std::string& content) {
-	std::regex rgx("const");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Const, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_cin(std::string& content) {
-	std::regex rgx("cin");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Cin, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_cout(std::string& content) {
-	std::regex rgx("cout");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Cout, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-bool Lexer::match_void(std::string& content) {
-	std::regex rgx("void");
-	std::smatch it;
-
-	if (std::regex_search(content, it, rgx, std::regex_constants::match_continuous)) {
-		unsigned len = it.str().length();
-
-		tokens.push_back(Token(TokenType::Void, it.str(), line, column, len));
-		column = column + len;
-
-		content = it.suffix();
-		return true;
-	}
-
-	return false;
-}
-
-
-void Lexer::match_token(std::string& content) {
-	if (match_newline(content)) {
+void Lexer::match_token(std::string_view& content) {
+	if (match_fast_path(content)) {
 		return;
 	}
 
-	if (match_header(content)) {
+	if (try_rule<&Lexer::match_newline>("newline", content)) {
 		return;
 	}
 
-	if (match_using(content)) {
+	if (try_rule<&Lexer::match_float_constant>("float_constant", content)) {
 		return;
 	}
 
-	if (match_namespace(content)) {
+	if (try_rule<&Lexer::match_int_constant>("int_constant", content)) {
 		return;
 	}
 
-	if (match_break(content)) {
+	if (try_rule<&Lexer::match_char_constant>("char_constant", content)) {
 		return;
 	}
 
-	if (match_case(content)) {
+	if (try_rule<&Lexer::match_include_directive>("include_directive", content)) {
 		return;
 	}
 
-	if (match_class(content)) {
+	if (try_rule<&Lexer::match_left_paren>("left_paren", content)) {
 		return;
 	}
 
-	if (match_integer_type(content)) {
+	if (try_rule<&Lexer::match_right_paren>("right_paren", content)) {
 		return;
 	}
 
-	if (match_float_type(content)) {
+	if (try_rule<&Lexer::match_left_brace>("left_brace", content)) {
 		return;
 	}
 
-	if (match_string_type(content)) {
+	if (try_rule<&Lexer::match_right_brace>("right_brace", content)) {
 		return;
 	}
 
-	if (match_char_type(content)) {
+	if (try_rule<&Lexer::match_colon>("colon", content)) {
 		return;
 	}
 
-	if (match_unsigned_type(content)) {
+	if (try_rule<&Lexer::match_semicolon>("semicolon", content)) {
 		return;
 	}
 
-	if (match_bool_type(content)) {
+	if (try_rule<&Lexer::match_comma>("comma", content)) {
 		return;
 	}
 
-	if (match_new(content)) {
+	if (try_rule<&Lexer::match_dot_operator>("dot_operator", content)) {
 		return;
 	}
 
-	if (match_access_specifier(content)) {
+	if (try_rule<&Lexer::match_bracket_operator>("bracket_operator", content)) {
 		return;
 	}
 
-	if (match_if(content)) {
+	if (try_rule<&Lexer::match_equal_equal>("equal_equal", content)) {
 		return;
 	}
 
-	if (match_else(content)) {
+	if (try_rule<&Lexer::match_equal>("equal", content)) {
 		return;
 	}
 
-	if (match_bool_value(content)) {
+	if (try_rule<&Lexer::match_greater_equal>("greater_equal", content)) {
 		return;
 	}
 
-	if (match_return(content)) {
+	if (try_rule<&Lexer::match_less_equal>("less_equal", content)) {
 		return;
 	}
 
-	if (match_while(content)) {
+	if (try_rule<&Lexer::match_not_equal>("not_equal", content)) {
 		return;
 	}
 
-	if (match_for(content)) {
-		return;
-	}
-	
-	if (match_float_constant(content)) {
+	if (try_rule<&Lexer::match_left_shift>("left_shift", content)) {
 		return;
 	}
 
-	if (match_do(content)) {
+	if (try_rule<&Lexer::match_right_shift>("right_shift", content)) {
 		return;
 	}
 
-	if (match_const(content)) {
+	if (try_rule<&Lexer::match_less>("less", content)) {
 		return;
 	}
 
-	if (match_void(content)) {
+	if (try_rule<&Lexer::match_greater>("greater", content)) {
 		return;
 	}
 
-	if (match_int_constant(content)) {
+	if (try_rule<&Lexer::match_plus_plus>("plus_plus", content)) {
 		return;
 	}
 
-	if (match_string_constant(content)) {
+	if (try_rule<&Lexer::match_minus_minus>("minus_minus", content)) {
 		return;
 	}
 
-	if (match_char_constant(content)) {
+	if (try_rule<&Lexer::match_plus>("plus", content)) {
 		return;
 	}
 
-	if (match_include_directive(content)) {
+	if (try_rule<&Lexer::match_minus>("minus", content)) {
 		return;
 	}
 
-	if (match_left_paren(content)) {
+	if (try_rule<&Lexer::match_multiline_comment_end>("multiline_comment_end", content)) {
 		return;
 	}
 
-	if (match_right_paren(content)) {
+	if (try_rule<&Lexer::match_star>("star", content)) {
 		return;
 	}
 
-	if (match_left_brace(content)) {
+	if (try_rule<&Lexer::match_division>("division", content)) {
 		return;
 	}
 
-	if (match_right_brace(content)) {
+	if (try_rule<&Lexer::match_modulo>("modulo", content)) {
 		return;
 	}
 
-	if (match_colon(content)) {
+	if (try_rule<&Lexer::match_bitwise_xor>("bitwise_xor", content)) {
 		return;
 	}
 
-	if (match_semicolon(content)) {
+	if (try_rule<&Lexer::match_bitwise_not>("bitwise_not", content)) {
 		return;
 	}
 
-	if (match_comma(content)) {
+	if (try_rule<&Lexer::match_logical_and>("logical_and", content)) {
 		return;
 	}
 
-	if (match_dot_operator(content)) {
+	if (try_rule<&Lexer::match_logical_or>("logical_or", content)) {
 		return;
 	}
 
-	if (match_bracket_operator(content)) {
+	if (try_rule<&Lexer::match_scope_operator>("scope_operator", content)) {
 		return;
 	}
 
-	if (match_equal_equal(content)) {
+	if (try_rule<&Lexer::match_arrow>("arrow", content)) {
 		return;
 	}
 
-	if (match_equal(content)) {
+	if (try_rule<&Lexer::match_plus_equal>("plus_equal", content)) {
 		return;
 	}
 
-	if (match_greater_equal(content)) {
+	if (try_rule<&Lexer::match_minus_equal>("minus_equal", content)) {
 		return;
 	}
 
-	if (match_less_equal(content)) {
+	if (try_rule<&Lexer::match_star_equal>("star_equal", content)) {
 		return;
 	}
 
-	if (match_not_equal(content)) {
+	if (try_rule<&Lexer::match_divide_equal>("divide_equal", content)) {
 		return;
 	}
 
-	if (match_left_shift(content)) {
+	if (try_rule<&Lexer::match_modulo_equal>("modulo_equal", content)) {
 		return;
 	}
 
-	if (match_right_shift(content)) {
-		return;
-	}
+}
 
-	if (match_less(content)) {
+void Lexer::match_token_dfa(std::string_view& content) {
+	if (match_fast_path(content)) {
 		return;
 	}
 
-	if (match_greater(content)) {
-		return;
-	}
+	try_rule<&Lexer::match_dfa>("dfa", content);
+}
 
-	if (match_plus_plus(content)) {
-		return;
-	}
+// every rule the fast path leaves, in one pass over the input
+bool Lexer::match_dfa(std::string_view& content) {
+	ScanResult result = DfaScanner::lexer_rules().scan(content.data(), content.data() + content.size());
+	furthest = std::max(furthest, offset_of(content) + size_t(result.examined));
 
-	if (match_minus_minus(content)) {
-		return;
+	if (!result.matched) {
+		return false;
 	}
 
-	if (match_plus(content)) {
-		return;
+	if (result.type == TokenType::NewLine) {
+		lines.add_line(offset_of(content) + result.length);
 	}
-
-	if (match_minus(content)) {
-		return;
+	else {
+		emit(Token(result.type, offset_of(content), result.length));
 	}
 
-	if (match_multiline_comment_start(content)) {
-		return;
-	}
+	content.remove_prefix(result.length);
+	return true;
+}
 
-	if (match_multiline_comment_end(content)) {
-		return;
+void Lexer::emit(Token token) {
+	// whichever rule took a number, its value is worked out here and nowhere after
+	if (token.type == TokenType::IntConst || token.type == TokenType::UnsignedConst) {
+		token.integer = integer_literal_value(token.value(raw_content));
 	}
-
-	if (match_star(content)) {
-		return;
+	else if (token.type == TokenType::FloatConst) {
+		token.real = float_literal_value(token.value(raw_content));
 	}
 
-	if (match_line_comment(content)) {
-		return;
-	}
+	pending = token;
+	has_pending = true;
+}
 
-	if (match_division(content)) {
-		return;
-	}
+Token Lexer::next() {
+	// the cursor only moves forward over raw_content, nothing is copied per token
+	while (!cursor.empty()) {
+		remove_whitespaces_at_start(cursor);
 
-	if (match_modulo(content)) {
-		return;
-	}
+		if (offset_of(cursor) >= limit) {
+			return Token(TokenType::EndOfTokens, offset_of(cursor));
+		}
 
-	if (match_bitwise_xor(content)) {
-		return;
-	}
+		size_t previous = cursor.size();
 
-	if (match_bitwise_not(content)) {
-		return;
-	}
+		if (backend == LexerBackend::Dfa) {
+			match_token_dfa(cursor);
+		}
+		else {
+			// the regex chain doesn't tell how far it looked, so assume everything
+			match_token(cursor);
+			furthest = raw_content.size() + 1;
+		}
 
-	if (match_logical_and(content)) {
-		return;
-	}
+		// nothing matched, lexing stops here
+		if (cursor.size() == previous) {
+			cursor.remove_prefix(cursor.size());
+		}
 
-	if (match_logical_or(content)) {
-		return;
+		if (has_pending) {
+			has_pending = false;
+			return pending;
+		}
 	}
 
-	if (match_scope_operator(content)) {
-		return;
-	}
+	furthest = raw_content.size() + 1;
 
-	if (match_arrow(content)) {
-		return;
-	}
+	return Token(TokenType::EndOfTokens, raw_content.size());
+}
 
-	if (match_plus_equal(content)) {
-		return;
-	}
+void Lexer::resume(unsigned offset) {
+	cursor = raw_content.substr(offset);
+	has_pending = false;
+	furthest = offset;
+}
 
-	if (match_minus_equal(content)) {
-		return;
-	}
+size_t Lexer::reach() const {
+	return furthest;
+}
 
-	if (match_star_equal(content)) {
-		return;
-	}
+void Lexer::stop_at(size_t offset) {
+	limit = offset;
+}
 
-	if (match_divide_equal(content)) {
-		return;
-	}
+size_t Lexer::position() const {
+	return offset_of(cursor);
+}
 
-	if (match_modulo_equal(content)) {
-		return;
-	}
+void Lexer::produce_tokens() {
+	Token token = next();
 
-	if (match_cin(content)) {
-		return;
+	while (token.type != TokenType::EndOfTokens) {
+		tokens.push_back(token);
+		token = next();
 	}
 
-	if (match_cout(content)) {
-		return;
-	}
+	tokens.push_back(token);
 
-	if (match_identifier(content)) {
-		return;
+	if constexpr (lexer_stats_enabled) {
+		stats.print(std::cerr);
 	}
 }
 
-void Lexer::produce_tokens() {
-
-		while (raw_content != "") {
-			remove_whitespaces_at_start(raw_content);
-
-			std::string previous = raw_content;
-
-			match_token(raw_content);
-
-			if (raw_content == previous) {
-				break;
-			}
-		}
-
-		tokens.push_back(Token(TokenType::EndOfTokens));
-}
\ No newline at end of file
+void print_tokens(const TokenColumns& tokens, std::string_view source, const LineTable& lines, std::ostream& out) {
+	for (size_t i = 0; i < tokens.count; i++) {
+		out << SourceToken{ tokens[i], source, lines } << '\n';
+	}
+}
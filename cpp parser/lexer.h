@@ -1,121 +1,157 @@
 #pragma once
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "token.h"
+#include "token-array.h"
+#include "line-table.h"
+#include "lexer-stats.h"
 
+enum class LexerBackend {
+	Regex,
+	Dfa
+};
 
 class Lexer {
-	std::string raw_content;
-	unsigned line;
-	unsigned column;
+	std::string owned_content;
+	std::string_view raw_content;
+	std::string_view cursor;
+	Token pending;
+	bool has_pending;
+	size_t furthest;
+	bool keep_comments;
+	size_t limit;
+	LexerBackend backend;
+	LexerStats stats;
 	
-	void match_token(std::string& content);
-
-	void remove_whitespaces_at_start(std::string& str);
-
-	bool match_plus_equal(std::string& content);
-	bool match_minus_equal(std::string& content);
-	bool match_star_equal(std::string& content);
-	bool match_divide_equal(std::string& content);
-	bool match_modulo_equal(std::string& content);
-
-	bool match_left_shift_equal(std::string& content);
-	bool match_right_shift_equal(std::string& content);
-	bool match_bitwise_and_equal(std::string& content);
-	bool match_bitwise_or_equal(std::string& content);
-	bool match_bitwise_xor_equal(std::string& content);
-	bool match_bitwise_and(std::string& content);
-	bool match_bitwise_or(std::string& content);
-	bool match_bitwise_not(std::string& content);
-	bool match_bitwise_xor(std::string& content);
-	bool match_left_shift(std::string& content);
-	bool match_right_shift(std::string& content);
-	bool match_logical_and(std::string& content);
-	bool match_logical_or(std::string& content);
-
-	bool match_scope_operator(std::string& content);
-	bool match_arrow(std::string& content);
-
-	bool match_plus_plus(std::string& content);
-	bool match_minus_minus(std::string& content);
-	bool match_plus(std::string& content);
-	bool match_star(std::string& content);
-	bool match_minus(std::string& content);
-	bool match_modulo(std::string& content);
-	bool match_division(std::string& content);
+	unsigned offset_of(std::string_view content) const;
+	void emit(Token token);
+	void emit_comment(Token token);
+	void move_over(std::string_view text);
+
+	void match_token(std::string_view& content);
+	void match_token_dfa(std::string_view& content);
+
+	void remove_whitespaces_at_start(std::string_view& str);
+
+	bool match_plus_equal(std::string_view& content);
+	bool match_minus_equal(std::string_view& content);
+	bool match_star_equal(std::string_view& content);
+	bool match_divide_equal(std::string_view& content);
+	bool match_modulo_equal(std::string_view& content);
+
+	bool match_left_shift_equal(std::string_view& content);
+	bool match_right_shift_equal(std::string_view& content);
+	bool match_bitwise_and_equal(std::string_view& content);
+	bool match_bitwise_or_equal(std::string_view& content);
+	bool match_bitwise_xor_equal(std::string_view& content);
+	bool match_bitwise_and(std::string_view& content);
+	bool match_bitwise_or(std::string_view& content);
+	bool match_bitwise_not(std::string_view& content);
+	bool match_bitwise_xor(std::string_view& content);
+	bool match_left_shift(std::string_view& content);
+	bool match_right_shift(std::string_view& content);
+	bool match_logical_and(std::string_view& content);
+	bool match_logical_or(std::string_view& content);
+
+	bool match_scope_operator(std::string_view& content);
+	bool match_arrow(std::string_view& content);
+
+	bool match_plus_plus(std::string_view& content);
+	bool match_minus_minus(std::string_view& content);
+	bool match_plus(std::string_view& content);
+	bool match_star(std::string_view& content);
+	bool match_minus(std::string_view& content);
+	bool match_modulo(std::string_view& content);
+	bool match_division(std::string_view& content);
 	
-	bool match_less_equal(std::string& content);
-	bool match_greater_equal(std::string& content);
-	bool match_equal_equal(std::string& content);
-	bool match_not_equal(std::string& content);
-	bool match_equal(std::string& content);
-	bool match_less(std::string& content);
-	bool match_greater(std::string& content);
-
-	bool match_include_directive(std::string& content);
-	bool match_header(std::string& content);
-
-	bool match_left_paren(std::string& content);
-	bool match_right_paren(std::string& content);
-	bool match_left_brace(std::string& content);
-	bool match_right_brace(std::string& content);
-	bool match_colon(std::string& content);
-	bool match_semicolon(std::string& content);
-	bool match_comma(std::string& content);
-	bool match_dot_operator(std::string& content);
-	bool match_tilde(std::string& content);
-	bool match_bracket_operator(std::string& content);
-
-	bool match_int_constant(std::string& content);
-	bool match_unsigned_constant(std::string& content);
-	bool match_float_constant(std::string& content);
-	bool match_char_constant(std::string& content);
-	bool match_string_constant(std::string& content);
-	bool match_identifier(std::string& content);
-
-	bool match_newline(std::string& content);
-	bool match_line_comment(std::string& content);
-	bool match_multiline_comment_start(std::string& content);
-	bool match_multiline_comment_end(std::string& content);
-
-	bool match_break(std::string& content);
-	bool match_case(std::string& content);
-	bool match_class(std::string& content); // struct too
-	bool match_delete(std::string& content);
-
-	bool match_integer_type(std::string& content);
-	bool match_float_type(std::string& content);
-	bool match_string_type(std::string& content);
-	bool match_char_type(std::string& content);
-	bool match_unsigned_type(std::string& content);
-	bool match_bool_type(std::string& content);
-
-	bool match_new(std::string& content);
-	bool match_access_specifier(std::string& content); // public private protected
-	bool match_if(std::string& content);
-	bool match_else(std::string& content);
-
-	bool match_bool_value(std::string& content); // true false
-	bool match_return(std::string& content);
-
-	bool match_while(std::string& content);
-	bool match_for(std::string& content);
-	bool match_do(std::string& content);
-
-	bool match_const(std::string& content);
-	bool match_void(std::string& content);
-
-	bool match_using(std::string& content);
-	bool match_namespace(std::string& content);
-
-	bool match_cin(std::string& content);
-	bool match_cout(std::string& content);
+	bool match_less_equal(std::string_view& content);
+	bool match_greater_equal(std::string_view& content);
+	bool match_equal_equal(std::string_view& content);
+	bool match_not_equal(std::string_view& content);
+	bool match_equal(std::string_view& content);
+	bool match_less(std::string_view& content);
+	bool match_greater(std::string_view& content);
+
+	bool match_include_directive(std::string_view& content);
+	bool match_header(std::string_view& content);
+
+	bool match_left_paren(std::string_view& content);
+	bool match_right_paren(std::string_view& content);
+	bool match_left_brace(std::string_view& content);
+	bool match_right_brace(std::string_view& content);
+	bool match_colon(std::string_view& content);
+	bool match_semicolon(std::string_view& content);
+	bool match_comma(std::string_view& content);
+	bool match_dot_operator(std::string_view& content);
+	bool match_tilde(std::string_view& content);
+	bool match_bracket_operator(std::string_view& content);
+
+	bool match_int_constant(std::string_view& content);
+	bool match_unsigned_constant(std::string_view& content);
+	bool match_float_constant(std::string_view& content);
+	bool match_char_constant(std::string_view& content);
+	bool match_string_constant(std::string_view& content);
+
+	bool match_newline(std::string_view& content);
+	bool match_line_comment(std::string_view& content);
+	bool match_multiline_comment(std::string_view& content);
+	bool match_multiline_comment_end(std::string_view& content);
+
+	bool match_delete(std::string_view& content);
+
+	// identifiers and keywords, scanned once and told apart by the keyword table
+	bool match_word(std::string_view& content);
+	bool match_digits(std::string_view& content);
+	bool match_fast_path(std::string_view& content);
+	bool match_dfa(std::string_view& content);
+
+	// calls the rule, counting and timing it when built with LEXER_STATS
+	template <bool (Lexer::*rule)(std::string_view&)>
+	bool try_rule(const char* name, std::string_view& content);
 	
 public:
 
-	std::vector<Token> tokens;
-	Lexer(std::string content);
+	TokenArray tokens;
+
+	// where the lines start, as far as the lexer got, a resumed lexer only adds the ones after where it resumed
+	LineTable lines;
+
+	Lexer(std::string content, LexerBackend backend = LexerBackend::Dfa);
+
+	// lexes a buffer owned by the caller (e.g. a MappedFile) without copying it, it must outlive the lexer
+	Lexer(const char* data, size_t size, LexerBackend backend = LexerBackend::Dfa);
+
+	Lexer(const Lexer& other) = delete;
+	Lexer& operator=(const Lexer& other) = delete;
+
+	// lexes one more token, EndOfTokens once the input is used up (and on every call after that)
+	Token next();
 
 	void produce_tokens();
-	void print_tokens() const;
-};
\ No newline at end of file
+
+	// comments are lexed as one token each either way, without them they are skipped like whitespace
+	void set_keep_comments(bool keep);
+
+	// continues lexing from a token boundary as if everything before it had already been lexed
+	void resume(unsigned offset);
+
+	// one past the last byte the tokens so far depended on, editing at or after it cannot change them
+	size_t reach() const;
+
+	// next() gives EndOfTokens instead of a token that would start at or after offset, until moved again
+	void stop_at(size_t offset);
+
+	// where the next token is looked for, the end of the input once nothing matched
+	size_t position() const;
+	void print_tokens(std::ostream& out) const;
+
+	std::string_view source() const;
+
+	// empty unless built with LEXER_STATS
+	const LexerStats& get_stats() const;
+};
+
+// one line per token as Lexer::print_tokens gives them, for tokens that didn't come from a Lexer
+void print_tokens(const TokenColumns& tokens, std::string_view source, const LineTable& lines, std::ostream& out);
\ No newline at end of file
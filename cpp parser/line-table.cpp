@@ -0,0 +1,73 @@
+#include "line-table.h"
+#include <algorithm>
+#include <cstring>
+
+std::ostream& operator<<(std::ostream& os, SourcePosition position) {
+	return os << position.line << ' ' << position.column;
+}
+
+LineTable::LineTable() {
+	starts.push_back(0);
+}
+
+LineTable::LineTable(std::string_view source) {
+	starts.push_back(0);
+
+	const char* begin = source.data();
+	const char* end = begin + source.size();
+
+	for (const char* newline = static_cast<const char*>(std::memchr(begin, '\n', source.size())); newline != nullptr;
+		newline = static_cast<const char*>(std::memchr(newline + 1, '\n', end - newline - 1))) {
+		starts.push_back(newline - begin + 1);
+	}
+}
+
+void LineTable::add_line(std::uint32_t start) {
+	starts.push_back(start);
+}
+
+void LineTable::append(const LineTable& other) {
+	auto first = std::upper_bound(other.starts.begin(), other.starts.end(), starts.back());
+	starts.insert(starts.end(), first, other.starts.end());
+}
+
+// starts whose newline was in the replaced range go, the ones after it move
+void LineTable::apply_edit(size_t offset, size_t removed, std::string_view inserted) {
+	std::int64_t delta = std::int64_t(inserted.size()) - std::int64_t(removed);
+
+	auto first = std::upper_bound(starts.begin(), starts.end(), std::uint32_t(offset));
+	auto last = std::upper_bound(first, starts.end(), std::uint32_t(offset + removed));
+
+	for (auto it = last; it != starts.end(); it++) {
+		*it = std::uint32_t(*it + delta);
+	}
+
+	std::vector<std::uint32_t> fresh;
+
+	for (size_t i = 0; i < inserted.size(); i++) {
+		if (inserted[i] == '\n') {
+			fresh.push_back(std::uint32_t(offset + i + 1));
+		}
+	}
+
+	first = starts.erase(first, last);
+	starts.insert(first, fresh.begin(), fresh.end());
+}
+
+SourcePosition LineTable::position(std::uint32_t offset) const {
+	size_t line = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin();
+
+	return SourcePosition{ std::uint32_t(line), offset - starts[line - 1] + 1 };
+}
+
+size_t LineTable::line_count() const {
+	return starts.size();
+}
+
+SourcePosition position_of(const Token& token, const LineTable& lines) {
+	if (token.type == TokenType::EndOfTokens) {
+		return SourcePosition{ 0, 0 };
+	}
+
+	return lines.position(token.offset);
+}
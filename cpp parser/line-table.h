@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "token.h"
+
+struct SourcePosition {
+	std::uint32_t line;
+	std::uint32_t column;
+};
+
+// prints "line column", the way token positions have always been printed
+std::ostream& operator<<(std::ostream& os, SourcePosition position);
+
+// offsets where the lines of a buffer start, tokens only keep their offset and this turns it into a
+// line and column when something has to print them, only '\n' starts a line
+class LineTable {
+	std::vector<std::uint32_t> starts;
+
+public:
+
+	// just the first line, the rest is added as the newlines are found
+	LineTable();
+
+	// every line of the buffer
+	explicit LineTable(std::string_view source);
+
+	// starts have to come in increasing order
+	void add_line(std::uint32_t start);
+
+	// the starts of other after the last one here, for tables built over consecutive parts of a buffer
+	void append(const LineTable& other);
+
+	// keeps the table in step with text.replace(offset, removed, inserted)
+	void apply_edit(size_t offset, size_t removed, std::string_view inserted);
+
+	SourcePosition position(std::uint32_t offset) const;
+	size_t line_count() const;
+};
+
+// EndOfTokens has no place in the source and is printed at 0 0
+SourcePosition position_of(const Token& token, const LineTable& lines);
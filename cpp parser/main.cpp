@@ -3,36 +3,152 @@
 #include <vector>
 #include <regex>
 #include <algorithm>
+#include <thread>
+#include <memory>
 #include "lexer.h"
 #include "parser.h"
+#include "flat-ast.h"
 #include "utility_funcs.h"
+#include "mapped-file.h"
+#include "batch-driver.h"
+#include "parallel-lexer.h"
+#include "token-cache.h"
+#include "stream-lexer.h"
+
+int main(int argc, char* argv[]) {
+	LexerBackend backend = LexerBackend::Dfa;
+	bool batch = false;
+	bool stream = false;
+	size_t chunk_kb = 1024;
+	unsigned jobs = std::thread::hardware_concurrency();
+	unsigned lex_jobs = 1;
+	std::string cache_directory;
+	std::uintmax_t cache_megabytes = 256;
+	std::vector<std::string> batch_inputs;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--lexer=regex") {
+			backend = LexerBackend::Regex;
+		}
+		else if (arg == "--lexer=dfa") {
+			backend = LexerBackend::Dfa;
+		}
+		else if (arg == "--batch") {
+			batch = true;
+		}
+		else if (arg.rfind("--jobs=", 0) == 0) {
+			jobs = std::stoul(arg.substr(7));
+		}
+		else if (arg.rfind("--lex-jobs=", 0) == 0) {
+			lex_jobs = std::stoul(arg.substr(11));
+		}
+		else if (arg == "--stream") {
+			stream = true;
+		}
+		else if (arg.rfind("--chunk-kb=", 0) == 0) {
+			chunk_kb = std::stoul(arg.substr(11));
+		}
+		else if (arg.rfind("--token-cache=", 0) == 0) {
+			cache_directory = arg.substr(14);
+		}
+		else if (arg.rfind("--token-cache-mb=", 0) == 0) {
+			cache_megabytes = std::stoull(arg.substr(17));
+		}
+		else if (batch) {
+			batch_inputs.push_back(arg);
+		}
+	}
+
+	// compiler --token-cache=DIR [--token-cache-mb=N] keeps the tokens of every file it lexes in DIR
+	// and reads them back instead of lexing when the same bytes come again
+	std::unique_ptr<TokenCache> cache;
+
+	if (!cache_directory.empty()) {
+		cache = std::make_unique<TokenCache>(cache_directory, cache_megabytes * 1024 * 1024);
+	}
+
+	// compiler --batch [--jobs=N] <files or directories>
+	if (batch) {
+		return run_batch(batch_inputs, jobs, backend, cache.get());
+	}
+
+	// compiler --stream [--chunk-kb=N] < source lexes stdin as it arrives and only prints the tokens
+	if (stream) {
+		StreamLexer lexer(0, chunk_kb * 1024, backend);
+
+		for (Token token = lexer.next(); ; token = lexer.next()) {
+			std::cout << token_type_name(token.type) << ' ' << lexer.text(token) << ' ' << lexer.position(token) << '\n';
+
+			if (token.type == TokenType::EndOfTokens) {
+				return 0;
+			}
+		}
+	}
 
-int main() {
 	std::string file_name;
 	std::cin >> file_name;
-	
-	std::ifstream reader(file_name);
-	
-	std::string word;
-	std::vector<std::string> file_content;	
 
-	while (std::getline(reader,word)) {
-		file_content.push_back(word);
+	// the lexer reads straight from the mapping, the file is only copied if it cannot be mapped
+	MappedFile file(file_name);
+	std::unique_ptr<Lexer> lexer_holder;
+
+	if (file.is_open()) {
+		lexer_holder = std::make_unique<Lexer>(file.data(), file.size(), backend);
+	}
+	else {
+		lexer_holder = std::make_unique<Lexer>(read_file(file_name), backend);
+	}
+
+	Lexer& lexer = *lexer_holder;
+
+	std::unique_ptr<CachedTokens> cached;
+
+	if (cache != nullptr) {
+		cached = cache->find(lexer.source().data(), lexer.source().size());
+	}
+
+	// on a hit the tokens are parsed straight from the mapped entry and never copied
+	if (cached != nullptr) {
+		lexer.lines = LineTable(lexer.source());
+	}
+	// compiler --lex-jobs=N splits one big file between N threads for lexing
+	else if (lex_jobs > 1) {
+		lexer.tokens = lex_in_parallel(lexer.source().data(), lexer.source().size(), lex_jobs, lexer.lines, backend);
+	}
+	else {
+		lexer.produce_tokens();
+	}
+
+	if (cache != nullptr && cached == nullptr) {
+		cache->store(lexer.source().data(), lexer.source().size(), lexer.tokens);
 	}
 
-	std::string content_as_str = vec_to_str(file_content);
+	TokenColumns columns = cached != nullptr ? cached->columns() : lexer.tokens.columns();
 
-	Lexer lexer(content_as_str);
-	lexer.produce_tokens();
+	print_tokens(columns, lexer.source(), lexer.lines, std::cout);
 
-	lexer.print_tokens();
+	// the parser trace goes to stderr, stdout only has the tokens and then the tree or the errors
+	TraceSink trace(std::cerr);
 
-	Parser parser(lexer.tokens);
+	Arena arena;
+	TokenStream tokens(columns);
+	Parser parser(tokens, lexer.source(), lexer.lines, arena, trace);
 
-	AST* tree = new AST("Program");
+	AST* tree = parser.make_ast("Program");
 
 	parser.parse_code(tree);
-	tree->print();
+	trace.flush();
+
+	// a program with errors gives them and no tree
+	if (!parser.get_diagnostics().empty()) {
+		print_diagnostics(parser.get_diagnostics(), lexer.lines, std::cout);
+		return -1;
+	}
+
+	FlatAST flat_tree(tree);
+	flat_tree.print(lexer.source(), lexer.lines);
 
 	return 0;
 }
\ No newline at end of file
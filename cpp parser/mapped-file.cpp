@@ -0,0 +1,122 @@
+#include "mapped-file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& file_name) {
+	begin = nullptr;
+	length = 0;
+	opened = false;
+	mapping_handle = nullptr;
+
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size)) {
+		return;
+	}
+
+	length = static_cast<size_t>(file_size.QuadPart);
+
+	// an empty file cannot be mapped but is still a valid input
+	if (length == 0) {
+		opened = true;
+		return;
+	}
+
+	mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_handle == nullptr) {
+		return;
+	}
+
+	begin = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	opened = begin != nullptr;
+}
+
+MappedFile::~MappedFile() {
+	if (begin != nullptr) {
+		UnmapViewOfFile(begin);
+	}
+	if (mapping_handle != nullptr) {
+		CloseHandle(mapping_handle);
+	}
+	if (file_handle != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_handle);
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& file_name) {
+	begin = nullptr;
+	length = 0;
+	opened = false;
+
+	descriptor = open(file_name.c_str(), O_RDONLY);
+
+	if (descriptor == -1) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(descriptor, &info) == -1 || !S_ISREG(info.st_mode)) {
+		return;
+	}
+
+	length = info.st_size;
+
+	// an empty file cannot be mapped but is still a valid input
+	if (length == 0) {
+		opened = true;
+		return;
+	}
+
+	void* memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (memory == MAP_FAILED) {
+		return;
+	}
+
+	// the lexer only walks forward through the file
+	madvise(memory, length, MADV_SEQUENTIAL);
+
+	begin = static_cast<const char*>(memory);
+	opened = true;
+}
+
+MappedFile::~MappedFile() {
+	if (begin != nullptr) {
+		munmap(const_cast<char*>(begin), length);
+	}
+	if (descriptor != -1) {
+		close(descriptor);
+	}
+}
+
+#endif
+
+bool MappedFile::is_open() const {
+	return opened;
+}
+
+const char* MappedFile::data() const {
+	return begin;
+}
+
+size_t MappedFile::size() const {
+	return length;
+}
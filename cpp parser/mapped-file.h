@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// read-only view of a whole file mapped into memory, unmapped when destroyed
+class MappedFile {
+	const char* begin;
+	size_t length;
+	bool opened;
+
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int descriptor;
+#endif
+
+public:
+
+	MappedFile(const std::string& file_name);
+	~MappedFile();
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	bool is_open() const;
+	const char* data() const;
+	size_t size() const;
+};
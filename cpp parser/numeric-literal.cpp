@@ -0,0 +1,190 @@
+#include "numeric-literal.h"
+#include "char-scan.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace {
+
+	bool is_digit(char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	bool is_hex_digit(char c) {
+		return is_digit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+	}
+
+	bool is_binary_digit(char c) {
+		return c == '0' || c == '1';
+	}
+
+	template <bool (*is_in)(char)>
+	size_t span_scalar(const char* begin, const char* end) {
+		const char* it = begin;
+
+		while (it != end && is_in(*it)) {
+			it++;
+		}
+
+		return it - begin;
+	}
+
+	// digits('digits)* from a position that holds a digit, up to where it ends
+	template <size_t (*span)(const char*, const char*), bool (*is_in)(char)>
+	size_t digit_run(std::string_view text, size_t from, size_t& examined) {
+		size_t end = from;
+
+		while (true) {
+			end += span(text.data() + end, text.data() + text.size());
+
+			if (end + 1 < text.size() && text[end] == '\'' && is_in(text[end + 1])) {
+				end++;
+				continue;
+			}
+
+			break;
+		}
+
+		examined = std::max(examined, std::min(end + 2, text.size() + 1));
+		return end;
+	}
+
+	size_t decimal_run(std::string_view text, size_t from, size_t& examined) {
+		return digit_run<span_digits, is_digit>(text, from, examined);
+	}
+
+	// [eE][+-]?[0-9]+ at the given position, without one the position comes back unchanged
+	size_t exponent_end(std::string_view text, size_t at, size_t& examined) {
+		examined = std::max(examined, std::min(at + 3, text.size() + 1));
+
+		if (at >= text.size() || (text[at] | 0x20) != 'e') {
+			return at;
+		}
+
+		size_t digits = at + 1;
+
+		if (digits < text.size() && (text[digits] == '+' || text[digits] == '-')) {
+			digits++;
+		}
+
+		if (digits >= text.size() || !is_digit(text[digits])) {
+			return at;
+		}
+
+		size_t end = digits + span_digits(text.data() + digits, text.data() + text.size());
+		examined = std::max(examined, std::min(end + 1, text.size() + 1));
+
+		return end;
+	}
+
+	// from_chars doesn't know the separators, literals with them are copied without
+	std::string_view without_separators(std::string_view text, std::string& buffer) {
+		if (std::memchr(text.data(), '\'', text.size()) == nullptr) {
+			return text;
+		}
+
+		buffer.assign(text);
+		buffer.erase(std::remove(buffer.begin(), buffer.end(), '\''), buffer.end());
+
+		return buffer;
+	}
+}
+
+NumericScan scan_numeric_literal(std::string_view text) {
+	if (text.empty() || !is_digit(text[0])) {
+		return NumericScan{ false, TokenType::EndOfTokens, 0, 1 };
+	}
+
+	size_t examined = std::min<size_t>(3, text.size() + 1);
+
+	if (text.size() > 2 && text[0] == '0' && (text[1] | 0x20) == 'x' && is_hex_digit(text[2])) {
+		size_t end = digit_run<span_scalar<is_hex_digit>, is_hex_digit>(text, 2, examined);
+		return NumericScan{ true, TokenType::IntConst, end, examined };
+	}
+
+	if (text.size() > 2 && text[0] == '0' && (text[1] | 0x20) == 'b' && is_binary_digit(text[2])) {
+		size_t end = digit_run<span_scalar<is_binary_digit>, is_binary_digit>(text, 2, examined);
+		return NumericScan{ true, TokenType::IntConst, end, examined };
+	}
+
+	size_t digits = decimal_run(text, 0, examined);
+
+	if (digits + 1 < text.size() && text[digits] == '.' && is_digit(text[digits + 1])) {
+		size_t fraction = decimal_run(text, digits + 1, examined);
+		return NumericScan{ true, TokenType::FloatConst, exponent_end(text, fraction, examined), examined };
+	}
+
+	size_t end = exponent_end(text, digits, examined);
+
+	if (end != digits) {
+		return NumericScan{ true, TokenType::FloatConst, end, examined };
+	}
+
+	// IntConst takes a leading 0 on its own
+	return NumericScan{ true, TokenType::IntConst, text[0] == '0' ? 1 : digits, examined };
+}
+
+std::uint64_t integer_literal_value(std::string_view text) {
+	bool negative = false;
+
+	if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+		negative = text[0] == '-';
+		text.remove_prefix(1);
+	}
+
+	int base = 10;
+
+	if (text.size() > 2 && text[0] == '0' && (text[1] | 0x20) == 'x') {
+		base = 16;
+		text.remove_prefix(2);
+	}
+	else if (text.size() > 2 && text[0] == '0' && (text[1] | 0x20) == 'b') {
+		base = 2;
+		text.remove_prefix(2);
+	}
+
+	std::string buffer;
+	std::string_view digits = without_separators(text, buffer);
+
+	std::uint64_t value = 0;
+
+	if (std::from_chars(digits.data(), digits.data() + digits.size(), value, base).ec == std::errc::result_out_of_range) {
+		value = std::numeric_limits<std::uint64_t>::max();
+	}
+
+	return negative ? 0 - value : value;
+}
+
+double float_literal_value(std::string_view text) {
+	bool negative = false;
+
+	if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+		negative = text[0] == '-';
+		text.remove_prefix(1);
+	}
+
+	std::string buffer;
+	std::string_view digits = without_separators(text, buffer);
+
+	double value = 0;
+
+	if (std::from_chars(digits.data(), digits.data() + digits.size(), value).ec == std::errc::result_out_of_range) {
+		// too big or too small, told apart by where the first significant digit sits
+		size_t exponent_at = std::min(digits.find_first_of("eE"), digits.size());
+		size_t point = std::min(digits.find('.'), exponent_at);
+		size_t first_significant = digits.find_first_not_of("0.");
+
+		long magnitude = first_significant < point ? long(point - first_significant) : -long(first_significant - point);
+
+		if (exponent_at < digits.size()) {
+			magnitude += std::strtol(std::string(digits.substr(exponent_at + 1)).c_str(), nullptr, 10);
+		}
+
+		value = magnitude > 0 ? std::numeric_limits<double>::infinity() : 0;
+	}
+
+	return negative ? -value : value;
+}
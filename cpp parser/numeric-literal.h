@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "token.h"
+
+// the number at the start of some text, the same one the IntConst and FloatConst rules would take there
+//  - integers: 0, [1-9][0-9]*, 0x and 0b with hex and binary digits
+//  - floats: digits with a . and a fraction, an exponent or both
+//  - a ' may sit between any two digits
+struct NumericScan {
+	bool matched;
+	TokenType type;
+	size_t length;
+	size_t examined; // bytes looked at, the one after the literal included
+};
+
+// text has to start with a digit, signed literals are left to the lexer rules
+NumericScan scan_numeric_literal(std::string_view text);
+
+// values of literals as lexed, sign and separators included, a negative integer is stored in two's complement
+// integers too large for 64 bits become UINT64_MAX, floats out of range become infinity or 0
+std::uint64_t integer_literal_value(std::string_view text);
+double float_literal_value(std::string_view text);
@@ -0,0 +1,140 @@
+#include "parallel-lexer.h"
+#include "work-stealing-pool.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+	// below this a chunk isn't worth a thread
+	const size_t min_chunk_bytes = 64 * 1024;
+
+	struct Chunk {
+		size_t begin;
+		size_t end;
+		std::unique_ptr<Lexer> lexer;
+		Lexer* lexed_by; // the lexer of an earlier chunk when this one started inside a token
+		std::vector<Token> tokens;
+		size_t stopped_at;
+	};
+
+	void lex_until(Lexer& lexer, Chunk& chunk) {
+		lexer.stop_at(chunk.end);
+
+		for (Token token = lexer.next(); token.type != TokenType::EndOfTokens; token = lexer.next()) {
+			chunk.tokens.push_back(token);
+		}
+
+		chunk.stopped_at = lexer.position();
+	}
+
+	// boundaries go right after a newline, so a chunk never starts inside a line comment
+	std::vector<Chunk> split_at_lines(const char* data, size_t size, unsigned count) {
+		std::vector<Chunk> chunks;
+		size_t begin = 0;
+
+		for (unsigned i = 1; i <= count && begin < size; i++) {
+			size_t end = size;
+
+			if (i < count) {
+				size_t target = std::max(begin, size_t(double(size) * i / count));
+				const char* newline = static_cast<const char*>(std::memchr(data + target, '\n', size - target));
+
+				end = newline == nullptr ? size : newline - data + 1;
+			}
+
+			chunks.push_back(Chunk{ begin, end, nullptr, nullptr, {}, 0 });
+			begin = end;
+		}
+
+		return chunks;
+	}
+}
+
+TokenArray lex_in_parallel(const char* data, size_t size, unsigned jobs, LineTable& lines, LexerBackend backend) {
+	unsigned count = unsigned(std::min<size_t>(std::max(jobs, 1u), std::max<size_t>(size / min_chunk_bytes, 1)));
+
+	if (count == 1) {
+		Lexer lexer(data, size, backend);
+		lexer.produce_tokens();
+
+		lines = std::move(lexer.lines);
+		return std::move(lexer.tokens);
+	}
+
+	std::vector<Chunk> chunks = split_at_lines(data, size, count);
+	WorkStealingPool pool(jobs);
+
+	for (Chunk& chunk : chunks) {
+		pool.submit([&chunk, data, size, backend]() {
+			chunk.lexer = std::make_unique<Lexer>(data, size, backend);
+			chunk.lexer->resume(chunk.begin);
+
+			lex_until(*chunk.lexer, chunk);
+		});
+	}
+
+	pool.run();
+
+	// a chunk only stands if the tokens before it ended at or before its first byte and lexing went on
+	// past its start, otherwise the lexer of the previous chunk carries on over it
+	Chunk* previous = nullptr;
+	Lexer* lexer = nullptr;
+	size_t last_end = 0;
+	size_t used = 0;
+
+	for (Chunk& chunk : chunks) {
+		if (previous != nullptr && previous->stopped_at >= size) {
+			break;
+		}
+
+		if (previous != nullptr && last_end > chunk.begin) {
+			chunk.tokens.clear();
+			lex_until(*lexer, chunk);
+		}
+		else {
+			lexer = chunk.lexer.get();
+		}
+
+		chunk.lexed_by = lexer;
+
+		if (!chunk.tokens.empty()) {
+			last_end = chunk.tokens.back().offset + chunk.tokens.back().length;
+		}
+
+		previous = &chunk;
+		used++;
+	}
+
+	// every lexer noted the lines it stepped over, together they cover the buffer up to where lexing ended
+	lines = LineTable();
+
+	for (size_t i = 0; i < used; i++) {
+		if (i == 0 || chunks[i].lexed_by != chunks[i - 1].lexed_by) {
+			lines.append(chunks[i].lexed_by->lines);
+		}
+	}
+
+	std::vector<size_t> starts(used + 1, 0);
+
+	for (size_t i = 0; i < used; i++) {
+		starts[i + 1] = starts[i] + chunks[i].tokens.size();
+	}
+
+	TokenArray tokens;
+	tokens.resize(starts[used] + 1);
+
+	for (size_t i = 0; i < used; i++) {
+		pool.submit([&tokens, &chunks, &starts, i]() {
+			for (size_t j = 0; j < chunks[i].tokens.size(); j++) {
+				tokens.set(starts[i] + j, chunks[i].tokens[j]);
+			}
+		});
+	}
+
+	pool.run();
+
+	tokens.set(starts[used], Token(TokenType::EndOfTokens, size));
+
+	return tokens;
+}
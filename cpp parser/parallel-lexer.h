@@ -0,0 +1,10 @@
+#pragma once
+#include <vector>
+#include "lexer.h"
+
+// lexes a buffer split at line starts on several threads, the tokens are the same as Lexer::produce_tokens gives
+// every chunk is lexed as if it started outside any token, a chunk that turns out to start inside one
+// (a comment or string literal running over its first line) is lexed again by the chunk before it
+// lines gets the line starts of the whole buffer
+TokenArray lex_in_parallel(const char* data, size_t size, unsigned jobs, LineTable& lines,
+	LexerBackend backend = LexerBackend::Dfa);
@@ -0,0 +1,37 @@
+#pragma once
+#include <utility>
+#include "token.h"
+
+// where the parser couldn't go on, the token it stopped on
+struct Diagnostic {
+	Token token;
+};
+
+// what a parse function gives back, its value or the diagnostic that stopped it
+// for nodes a nullptr value still means the tokens there don't start what the function parses
+template <typename T>
+class ParseResult {
+	T result;
+	Diagnostic diagnostic;
+	bool failed;
+
+public:
+
+	ParseResult(T value) : result(std::move(value)), diagnostic{}, failed(false) {
+	}
+
+	ParseResult(Diagnostic diagnostic) : result(), diagnostic(diagnostic), failed(true) {
+	}
+
+	bool ok() const {
+		return !failed;
+	}
+
+	T& value() {
+		return result;
+	}
+
+	const Diagnostic& error() const {
+		return diagnostic;
+	}
+};
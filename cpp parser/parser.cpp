@@ -1,435 +1,634 @@
 #include "parser.h"
 #include "ast-builder.h"
 #include <iostream>
-#include <stack>
+#include <cstdint>
+#include <array>
 
-Parser::Parser(std::vector<Token> tokens_array) {
-	tokens = tokens_array;
-	current_token = 0;
+Parser::Parser(TokenStream& tokens, std::string_view source, const LineTable& lines, Arena& arena, TraceSink& trace)
+	: tokens(tokens), lines(lines), arena(arena), trace(trace) {
+	this->source = source;
+	item_diagnostics = 0;
 }
 
-bool Parser::match_type(Token token, TokenType type) {
-	return token.type == type;
+AST* Parser::make_ast(std::string_view label) {
+	return arena.make<AST>(label, arena);
 }
 
-bool Parser::match_one_of(Token token, std::vector<TokenType> types) {
-	for (TokenType token_type : types) {
-		if (token.type == token_type) {
-			return true;
-		}
-	}
+AST* Parser::make_ast(Token token) {
+	return arena.make<AST>(token, arena);
+}
 
-	return false;
+bool Parser::match_type(const Token& token, TokenType type) {
+	return token.type == type;
+}
+
+bool Parser::match_one_of(const Token& token, const TokenSet& types) {
+	return types.contains(token.type);
 }
 
 bool Parser::finished_parsing() {
-	return tokens[current_token].type == TokenType::EndOfTokens;
+	return tokens.peek_type() == TokenType::EndOfTokens;
 }
 
 Token Parser::next_token() {
-	current_token++;
+	tokens.advance();
 
 
 	if (finished_parsing()) {
 		return Token(TokenType::EndOfTokens);
 	}
 
-	return tokens[current_token];
+	return tokens.peek();
 }
-Token Parser::prev_token() {
-	current_token--;
 
-	return tokens[current_token];
+Token Parser::peek() {
+	return tokens.peek();
 }
 
-Token Parser::peek() {
-	return tokens[current_token];
+namespace {
+
+	// what is left to do after a statement rule returned its node
+	enum class StatementEnd {
+		Nothing,
+		Advance,
+		Semicolon, // the statement has to end with one, it is skipped
+		SemicolonTraced // the same, then the token after it goes to the trace
+	};
+
+	struct StatementRule {
+		ParseResult<AST*> (Parser::*parse)();
+		TokenSet first;
+		bool (*lookahead)(const TokenStream& tokens); // what the rule checks past the first token, nullptr for nothing
+		StatementEnd end;
+	};
+
+	constexpr TokenSet type_names{ TokenType::IntegerType, TokenType::FloatType, TokenType::String,
+		TokenType::Unsigned, TokenType::Bool, TokenType::Char };
+
+	constexpr TokenSet declared_types = type_names | TokenSet{ TokenType::Class, TokenType::Struct };
+	constexpr TokenSet return_types = type_names | TokenSet{ TokenType::Void };
+	constexpr TokenSet argument_starts = type_names | TokenSet{ TokenType::Identifier };
+
+	constexpr TokenSet class_keys{ TokenType::Class, TokenType::Struct };
+	constexpr TokenSet bool_constants{ TokenType::True, TokenType::False };
+	constexpr TokenSet single_operands{ TokenType::IntConst, TokenType::UnsignedConst, TokenType::FloatConst,
+		TokenType::Identifier };
+
+	constexpr TokenSet assignment_operators{ TokenType::Equal, TokenType::StarEqual, TokenType::DivideEqual,
+		TokenType::ModuloEqual, TokenType::PlusEqual, TokenType::MinusEqual, TokenType::LeftShiftEqual,
+		TokenType::RightShiftEqual, TokenType::BitwiseAndEqual, TokenType::BitwiseXorEqual, TokenType::BitwiseOrEqual };
+
+	bool declaration_follows(const TokenStream& tokens) {
+		return !tokens.available(2) || tokens.peek_type(2) == TokenType::Semicolon;
+	}
+
+	bool assignment_follows(const TokenStream& tokens) {
+		return tokens.peek_type(2) == TokenType::Equal;
+	}
+
+	bool assignment_operator_follows(const TokenStream& tokens) {
+		return assignment_operators.contains(tokens.peek_type(1));
+	}
+
+	bool function_name_follows(const TokenStream& tokens) {
+		return tokens.peek_type(1) == TokenType::Identifier && tokens.peek_type(2) == TokenType::LeftParen;
+	}
+
+	bool arguments_follow(const TokenStream& tokens) {
+		return tokens.peek_type(1) == TokenType::LeftParen;
+	}
+}
+
+// the rules of a statement list in the order they are tried, with a bit set for each one a token type can start
+class StatementTable {
+	std::vector<StatementRule> rules;
+	std::uint32_t by_first[size_t(TokenType::EndOfTokens) + 1];
+
+public:
+
+	StatementTable(std::vector<StatementRule> rules) : rules(std::move(rules)), by_first{} {
+		for (size_t i = 0; i < this->rules.size(); i++) {
+			for (size_t type = 0; type <= size_t(TokenType::EndOfTokens); type++) {
+				if (this->rules[i].first.contains(TokenType(type))) {
+					by_first[type] |= std::uint32_t(1) << i;
+				}
+			}
+		}
+	}
+
+	// the rules from index from on whose first token the type can be
+	std::uint32_t candidates(TokenType type, size_t from) const {
+		return by_first[size_t(type)] >> from << from;
+	}
+
+	const StatementRule& rule(size_t i) const {
+		return rules[i];
+	}
+};
+
+namespace {
+
+	const StatementTable& top_level_rules() {
+		static const StatementTable table({
+			{ &Parser::parse_line_comment, { TokenType::LineComment }, nullptr, StatementEnd::Advance },
+			{ &Parser::parse_multiline_comment, { TokenType::MultilineComment }, nullptr, StatementEnd::Advance },
+			{ &Parser::parse_include_expr, { TokenType::IncludeDirective }, nullptr, StatementEnd::Advance },
+			{ &Parser::parse_using_expr, { TokenType::Using }, nullptr, StatementEnd::Advance },
+			{ &Parser::parse_var_declaration_expr, declared_types,
+				declaration_follows, StatementEnd::Nothing },
+			{ &Parser::parse_decl_assignment_expr, type_names, assignment_follows, StatementEnd::Semicolon },
+			{ &Parser::parse_simple_assignment_expr, { TokenType::Identifier }, assignment_operator_follows,
+				StatementEnd::Semicolon },
+			{ &Parser::parse_func_definition_expr, return_types, function_name_follows,
+				StatementEnd::Nothing },
+			{ &Parser::parse_func_call_expr, { TokenType::Identifier }, arguments_follow, StatementEnd::Advance },
+			{ &Parser::parse_input_expr, { TokenType::Cin }, nullptr, StatementEnd::Semicolon },
+			{ &Parser::parse_output_expr, { TokenType::Cout }, nullptr, StatementEnd::Semicolon },
+			{ &Parser::parse_for_expr, { TokenType::For }, nullptr, StatementEnd::Nothing },
+			{ &Parser::parse_while_expr, { TokenType::While }, nullptr, StatementEnd::Nothing },
+			{ &Parser::parse_if_else_expr, { TokenType::If }, nullptr, StatementEnd::Nothing },
+			{ &Parser::parse_return_expr, { TokenType::Return }, nullptr, StatementEnd::Semicolon },
+			{ &Parser::parse_class_definition_expr, { TokenType::Class, TokenType::Struct }, nullptr, StatementEnd::Nothing }
+		});
+
+		return table;
+	}
+
+	const StatementTable& braces_rules() {
+		static const StatementTable table({
+			{ &Parser::parse_output_expr, { TokenType::Cout }, nullptr, StatementEnd::SemicolonTraced },
+			{ &Parser::parse_input_expr, { TokenType::Cin }, nullptr, StatementEnd::Semicolon },
+			{ &Parser::parse_return_expr, { TokenType::Return }, nullptr, StatementEnd::Semicolon },
+			{ &Parser::parse_var_declaration_expr, declared_types,
+				declaration_follows, StatementEnd::Nothing },
+			{ &Parser::parse_decl_assignment_expr, type_names, assignment_follows, StatementEnd::Semicolon },
+			{ &Parser::parse_simple_assignment_expr, { TokenType::Identifier }, assignment_operator_follows,
+				StatementEnd::Semicolon },
+			{ &Parser::parse_if_else_expr, { TokenType::If }, nullptr, StatementEnd::Nothing },
+			{ &Parser::parse_for_expr, { TokenType::For }, nullptr, StatementEnd::Nothing },
+			{ &Parser::parse_func_call_expr, { TokenType::Identifier }, arguments_follow, StatementEnd::Advance },
+			{ &Parser::parse_func_definition_expr, return_types, function_name_follows,
+				StatementEnd::Nothing },
+			{ &Parser::parse_class_definition_expr, { TokenType::Class, TokenType::Struct }, nullptr, StatementEnd::Advance }
+		});
+
+		return table;
+	}
 }
 
-AST* Parser::parse_include_expr() {
+// one pass over the rules in their order, the same as calling each in turn: a rule is only called when the
+// tokens at its turn can start it, and the next one is looked for among the rules after it
+void Parser::parse_statements(const StatementTable& table, std::vector<AST*>& nodes) {
+	size_t from = 0;
+
+	while (true) {
+		std::uint32_t candidates = table.candidates(tokens.peek_type(), from);
+		const StatementRule* rule = nullptr;
+
+		for (size_t i = from; (candidates >> i) != 0; i++) {
+			const StatementRule& candidate = table.rule(i);
+
+			if ((candidates >> i & 1) && (candidate.lookahead == nullptr || candidate.lookahead(tokens))) {
+				rule = &candidate;
+				from = i + 1;
+				break;
+			}
+		}
+
+		if (rule == nullptr) {
+			return;
+		}
+
+		ParseResult<AST*> parsed = (this->*rule->parse)();
+
+		if (!parsed.ok()) {
+			report(parsed.error());
+			skip_statement();
+			continue;
+		}
+
+		AST* node = parsed.value();
+
+		if (node == nullptr) {
+			continue;
+		}
+
+		if (rule->end == StatementEnd::Semicolon || rule->end == StatementEnd::SemicolonTraced) {
+			Token curr = peek();
+			if (curr.type != TokenType::Semicolon) {
+				report(Diagnostic{ curr });
+				skip_statement();
+				continue;
+			}
+		}
+
+		nodes.push_back(node);
+
+		if (rule->end != StatementEnd::Nothing) {
+			next_token();
+		}
+
+		if (rule->end == StatementEnd::SemicolonTraced) {
+			trace.write<TraceCategory::Statements, TraceLevel::Info>(SourceToken{ peek(), source, lines });
+		}
+	}
+}
+
+ParseResult<AST*> Parser::parse_include_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::IncludeDirective)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
-	AST* library = nullptr;
-	try { library = parse_library_expr(); }
-	catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+	ParseResult<AST*> library = parse_library_expr();
 
-	if (library != nullptr) {
-		nodes.push_back(library);
+	if (!library.ok()) {
+		return library;
+	}
+
+	if (library.value() != nullptr) {
+		nodes.push_back(library.value());
 
-		AST* result = new AST("IncludeExpr");
+		AST* result = make_ast("IncludeExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 
 
-	AST* header = nullptr;
-	try { header = parse_header_expr(); }
-	catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+	ParseResult<AST*> header = parse_header_expr();
 
-	if (header != nullptr) {
-		nodes.push_back(header);
+	if (!header.ok()) {
+		return header;
+	}
 
-		AST* result = new AST("IncludeExpr");
+	if (header.value() != nullptr) {
+		nodes.push_back(header.value());
+
+		AST* result = make_ast("IncludeExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
+
+	return Diagnostic{ curr };
 }
 
-AST* Parser::parse_library_expr() {
+ParseResult<AST*> Parser::parse_library_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::Less)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Greater)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
-	AST* result = new AST("LibraryExpr");
+	AST* result = make_ast("LibraryExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-AST* Parser::parse_header_expr() {
+ParseResult<AST*> Parser::parse_header_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::Header)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
-	AST* result = new AST("HeaderExpr");
+	AST* result = make_ast("HeaderExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-AST* Parser::parse_using_expr() {
+ParseResult<AST*> Parser::parse_using_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::Using)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Namespace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Semicolon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
-	AST* result = new AST("UsingExpr");
+	AST* result = make_ast("UsingExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-AST* Parser::parse_var_declaration_expr() {
+ParseResult<AST*> Parser::parse_var_declaration_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	// the expression isn't a declaration
-	if (current_token + 2 <= tokens.size() - 1
-		&& tokens[current_token + 2].type != TokenType::Semicolon) {
+	if (tokens.available(2)
+		&& tokens.peek_type(2) != TokenType::Semicolon) {
 		return nullptr;
 	}
 
-	std::vector<TokenType> accepted_types{ TokenType::IntegerType,TokenType::FloatType,
-	TokenType::String,TokenType::Unsigned,TokenType::Bool,TokenType::Char, TokenType::Class,
-	TokenType::Struct};
-
-	if (!match_one_of(curr, accepted_types)) {
+	if (!match_one_of(curr, declared_types)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Semicolon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
 	curr = next_token();
 
-	AST* result = new AST("VarDeclExpr");
+	AST* result = make_ast("VarDeclExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-int precedence(Token token) {
-	if (token.type == TokenType::BitwiseXor) {
-		return 3;
-	}
+namespace {
 
-	if (token.type == TokenType::Star || token.type == TokenType::Division || token.type == TokenType::Modulo) {
-		return 2;
-	}
+	struct BindingPower {
+		std::uint8_t power; // 0 for tokens that don't join two operands
+		std::uint8_t uses; // OperatorUse bits
+	};
 
-	if (token.type == TokenType::Plus || token.type == TokenType::Minus) {
-		return 1;
-	}
+	constexpr size_t token_type_count = size_t(TokenType::EndOfTokens) + 1;
 
-	if (token.type == TokenType::BitwiseNot) {
-		return 3;
+	constexpr BindingPower binary(int power, OperatorUse use) {
+		return BindingPower{ std::uint8_t(power), std::uint8_t(use) };
 	}
 
-	if (token.type == TokenType::LogicalAnd) {
-		return 2;
-	}
+	// looser operators come first as in C++, except ^ which binds tighter than * here as it always has
+	constexpr std::array<BindingPower, token_type_count> make_binding_powers() {
+		std::array<BindingPower, token_type_count> powers{};
 
-	if (token.type == TokenType::LogicalOr) {
-		return 1;
-	}
-}
+		powers[size_t(TokenType::RightShift)] = binary(1, OperatorUse::Input);
+		powers[size_t(TokenType::LeftShift)] = binary(1, OperatorUse::Output);
 
-AST* Parser::build_arithmetic_tree(std::vector<Token> tokens) {
-	std::stack<Token> ops;
-	std::stack<AST*> trees;
+		powers[size_t(TokenType::LogicalOr)] = binary(2, OperatorUse::Logical);
+		powers[size_t(TokenType::LogicalAnd)] = binary(3, OperatorUse::Logical);
 
-	std::vector<TokenType> accepted_types{ TokenType::IntConst,TokenType::UnsignedConst,TokenType::FloatConst,TokenType::Identifier };
+		// <<= has always passed for a comparison
+		powers[size_t(TokenType::EqualEqual)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::NotEqual)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::Less)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::LessEqual)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::Greater)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::GreaterEqual)] = binary(4, OperatorUse::Relational);
+		powers[size_t(TokenType::LeftShiftEqual)] = binary(4, OperatorUse::Relational);
 
-	for (int i = 0; i < tokens.size(); i++) {
-		if (match_one_of(tokens[i], accepted_types)) {
-			AST* tree = new AST(tokens[i]);
-			trees.push(tree);
-		}
-		else if (ops.empty() || tokens[i].type == TokenType::LeftParen) {
-			ops.push(tokens[i]);
-		}
-		else {
-			Token top_token = ops.top();
+		powers[size_t(TokenType::Plus)] = BindingPower{ 5, std::uint8_t(OperatorUse::Arithmetic) | std::uint8_t(OperatorUse::Concatenation) };
+		powers[size_t(TokenType::Minus)] = binary(5, OperatorUse::Arithmetic);
+		powers[size_t(TokenType::Star)] = binary(6, OperatorUse::Arithmetic);
+		powers[size_t(TokenType::Division)] = binary(6, OperatorUse::Arithmetic);
+		powers[size_t(TokenType::Modulo)] = binary(6, OperatorUse::Arithmetic);
+		powers[size_t(TokenType::BitwiseXor)] = binary(7, OperatorUse::Arithmetic);
 
-			if (top_token.type == TokenType::LeftParen) {
-				ops.push(tokens[i]);
-				continue;
-			}
+		return powers;
+	}
 
-			if (tokens[i].type == TokenType::RightParen) {
-				while (top_token.type != TokenType::LeftParen) {
-					ops.pop();
+	constexpr std::array<BindingPower, token_type_count> binding_powers = make_binding_powers();
 
-					std::vector<AST*> children;
-					AST* child1 = new AST(*trees.top());
-					trees.pop();
-					AST* child2 = new AST(*trees.top());
-					trees.pop();
+	bool joins(TokenType type, OperatorUse use) {
+		return (binding_powers[size_t(type)].uses & std::uint8_t(use)) != 0;
+	}
+}
 
-					children.push_back(child2);
-					children.push_back(child1);
+// precedence climbing over the operators of one use, lhs is the operand in front of the first of them
+// an operator of the same power continues the right operand, so every operator groups to the right
+// as the trees always have, a - b - c is a - (b - c)
+ParseResult<AST*> Parser::parse_binary(OperatorUse use, int min_power, AST* lhs) {
+	while (true) {
+		Token op = peek();
+		BindingPower power = binding_powers[size_t(op.type)];
 
-					AST* new_tree = new AST(top_token);
-					new_tree->add_children(children);
+		if (!joins(op.type, use) || power.power < min_power) {
+			return lhs;
+		}
 
-					trees.push(new_tree);
+		if (use == OperatorUse::Logical) {
+			trace.write<TraceCategory::Expressions, TraceLevel::Debug>(SourceToken{ op, source, lines }, '\n');
+		}
+		next_token();
 
-					top_token = ops.top();
-				}
-				ops.pop(); // removing the (
-				continue;
-			}
-			else if (precedence(tokens[i]) >= precedence(top_token)) {
-				ops.push(tokens[i]);
-			}
-			else {
-				ops.pop();
+		ParseResult<AST*> operand = parse_operand(use);
 
-				std::vector<AST*> children;
-				AST* child1 = new AST(*trees.top());
-				trees.pop();
-				AST* child2 = new AST(*trees.top());
-				trees.pop();
+		if (!operand.ok()) {
+			return operand;
+		}
 
-				children.push_back(child2);
-				children.push_back(child1);
+		ParseResult<AST*> rhs = parse_binary(use, power.power, operand.value());
 
-				AST* new_tree = new AST(top_token);
-				new_tree->add_children(children);
+		if (!rhs.ok()) {
+			return rhs;
+		}
 
-				trees.push(new_tree);
+		AST* tree = make_ast(op);
 
-				i--; // we will examine the same token from input again
-			}
+		// a logical operator that gives way to a looser one after it has always taken its operands the other
+		// way round, and the looser one goes to the trace again for each operator it ended
+		if (use == OperatorUse::Logical && joins(peek().type, use)) {
+			trace.write<TraceCategory::Expressions, TraceLevel::Debug>(SourceToken{ peek(), source, lines }, '\n');
+			tree->add_children(rhs.value(), lhs);
+		}
+		else {
+			tree->add_children(lhs, rhs.value());
 		}
-	}
-
-	AST* result;
 
-	while (!ops.empty()) {
-		Token op = ops.top();
-		ops.pop();
+		lhs = tree;
+	}
+}
 
-		std::vector<AST*> children;
-		AST* child1 = new AST(*trees.top());
-		trees.pop();
-		AST* child2 = new AST(*trees.top());
-		trees.pop();
+ParseResult<AST*> Parser::parse_operand(OperatorUse use) {
+	Token curr = peek();
 
-		children.push_back(child2);
-		children.push_back(child1);
+	switch (use) {
+	case OperatorUse::Arithmetic:
+		return parse_arithmetic_operand(false);
+	case OperatorUse::Logical:
+		return parse_logical_operand(false);
+	case OperatorUse::Concatenation:
+		if (match_type(curr, TokenType::StringConst) || match_type(curr, TokenType::Identifier)) {
+			next_token();
+			return make_ast(curr);
+		}
+		break;
+	case OperatorUse::Input:
+		if (match_type(curr, TokenType::Identifier)) {
+			next_token();
+			return make_ast(curr);
+		}
+		break;
+	case OperatorUse::Output: {
+		ParseResult<AST*> str_expr = parse_string_expr();
 
-		AST* new_tree = new AST(op);
-		new_tree->add_children(children);
+		if (!str_expr.ok() || str_expr.value() != nullptr) {
+			return str_expr;
+		}
 
-		trees.push(new_tree);
+		if (match_type(curr, TokenType::CharConst) || match_type(curr, TokenType::Identifier)) {
+			next_token();
+			return make_ast(curr);
+		}
+		break;
+	}
+	default:
+		break;
 	}
 
-	result = trees.top();
-
-	return result;
+	return Diagnostic{ curr };
 }
 
-AST* Parser::parse_arithmetic_expr() {
+// a number or a name, or a whole expression in parentheses, the leading operand of an expression gives
+// nullptr where any other fails, with the ( in front of it already taken
+ParseResult<AST*> Parser::parse_arithmetic_operand(bool leading) {
 	Token curr = peek();
-	std::vector<Token> tokens;
 
-	bool matched_one = false;
+	if (match_type(curr, TokenType::LeftParen)) {
+		next_token();
 
-	int open_paren = 0;
-	int close_paren = 0;
+		ParseResult<AST*> inner = parse_arithmetic_operand(leading);
 
-	while (match_type(curr, TokenType::LeftParen)) {
-		tokens.push_back(curr);
-		curr = next_token();
-		open_paren++;
-	}
+		if (!inner.ok() || inner.value() == nullptr) {
+			return inner;
+		}
 
-	std::vector<TokenType> accepted_types{ TokenType::IntConst,TokenType::UnsignedConst,TokenType::FloatConst, TokenType::Identifier };
+		inner = parse_binary(OperatorUse::Arithmetic, 0, inner.value());
 
-	std::vector<TokenType> accepted_ops{ TokenType::Plus,TokenType::Minus,TokenType::Star,
-		TokenType::Division,TokenType::Modulo,TokenType::BitwiseXor };
+		if (!inner.ok()) {
+			return inner;
+		}
 
-	if (!match_one_of(curr, accepted_types)) {
-		return nullptr;
+		curr = peek();
+		if (!match_type(curr, TokenType::RightParen)) {
+			return Diagnostic{ curr };
+		}
+		next_token();
+
+		return inner;
 	}
-	matched_one = true;
-	tokens.push_back(curr);
-	curr = next_token();
 
-	while (match_one_of(curr, accepted_ops)) {
-		tokens.push_back(curr);
-		curr = next_token();
+	if (match_one_of(curr, single_operands)) {
+		next_token();
+		return make_ast(curr);
+	}
 
-		while (match_type(curr, TokenType::LeftParen)) {
-			tokens.push_back(curr);
-			curr = next_token();
-			open_paren++;
-		}
+	if (leading) {
+		return nullptr;
+	}
 
-		if (!match_one_of(curr, accepted_types)) {
-			throw curr;
-		}
-		tokens.push_back(curr);
-		curr = next_token();
+	return Diagnostic{ curr };
+}
 
-		while (match_type(curr, TokenType::RightParen)) {
-			tokens.push_back(curr);
-			curr = next_token();
-			close_paren++;
-		}
-	}
+ParseResult<AST*> Parser::parse_arithmetic_expr() {
+	ParseResult<AST*> child = parse_arithmetic_operand(true);
 
-	if (open_paren != close_paren) {
-		throw "parentheses error";
+	if (!child.ok() || child.value() == nullptr) {
+		return child;
 	}
 
-	AST* child = build_arithmetic_tree(tokens);
-	std::vector<AST*> children = { child };
+	child = parse_binary(OperatorUse::Arithmetic, 0, child.value());
 
-	AST* result = new AST("ArithmExpr");
-	result->add_children(children);
+	if (!child.ok()) {
+		return child;
+	}
+
+	AST* result = make_ast("ArithmExpr");
+	result->add_child(child.value());
 
 	return result;
 }
 
-AST* Parser::parse_func_definition_expr() {
+ParseResult<AST*> Parser::parse_func_definition_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	// the expression isn't a func definition
-	if (current_token + 2 > tokens.size() - 1
-		|| tokens[current_token + 1].type != TokenType::Identifier
-		|| tokens[current_token + 2].type != TokenType::LeftParen) {
+	if (tokens.peek_type(1) != TokenType::Identifier
+		|| tokens.peek_type(2) != TokenType::LeftParen) {
 		return nullptr;
 	}
 
-	std::vector<TokenType> accepted_types{ TokenType::IntegerType,TokenType::FloatType,
-	TokenType::String,TokenType::Unsigned,TokenType::Bool,TokenType::Char, TokenType::Void };
-
-	if (!match_one_of(curr, accepted_types)) {
+	if (!match_one_of(curr, return_types)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* args = new AST("Arguments");
+	AST* args = make_ast("Arguments");
 
 	if (match_type(curr, TokenType::RightParen)) {
 		curr = next_token();
 	}
 	else {
-		std::vector<AST*> args_list = parse_func_args_expr();
-		args->add_children(args_list);
+		ParseResult<std::vector<AST*>> args_list = parse_func_args_expr();
+
+		if (!args_list.ok()) {
+			return args_list.error();
+		}
+		args->add_children(args_list.value());
 
 		curr = peek();
 
 		if (!match_type(curr, TokenType::RightParen)) {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 		curr = next_token();
 	}
@@ -437,7 +636,7 @@ AST* Parser::parse_func_definition_expr() {
 	nodes.push_back(args);
 
 	if (match_type(curr, TokenType::Semicolon)) {
-		AST* result = new AST("FuncDeclExpr");
+		AST* result = make_ast("FuncDeclExpr");
 		result->add_children(nodes);
 
 		next_token();
@@ -446,47 +645,47 @@ AST* Parser::parse_func_definition_expr() {
 	}
 	else if (match_type(curr, TokenType::LeftBrace)) {
 		next_token();
-		AST* body = parse_braces_body("FuncBody");
+		ParseResult<AST*> body = parse_braces_body("FuncBody");
 
-		if (body != nullptr) {
-			nodes.push_back(body);
+		if (!body.ok()) {
+			return body;
+		}
+
+		if (body.value() != nullptr) {
+			nodes.push_back(body.value());
 		}
 		else {
 			curr = peek();
-			throw curr;
+			return Diagnostic{ curr };
 		}
 
-		AST* result = new AST("FuncDefExpr");
+		AST* result = make_ast("FuncDefExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 	
-	throw curr;
+	return Diagnostic{ curr };
 }
 
-std::vector<AST*> Parser::parse_func_args_expr() {
+ParseResult<std::vector<AST*>> Parser::parse_func_args_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
-	std::vector<TokenType> accepted_types{ TokenType::IntegerType,TokenType::FloatType,
-	TokenType::String,TokenType::Unsigned,TokenType::Bool,TokenType::Char,TokenType::Identifier };
-
 	bool matched_one = false;
 
-	while (match_one_of(curr, accepted_types)) {
-		AST* new_node = new AST("DeclExpr");
+	while (match_one_of(curr, argument_starts)) {
+		AST* new_node = make_ast("DeclExpr");
 		std::vector<AST*> node_children;
 
-		node_children.push_back(new AST(Token(curr)));
+		node_children.push_back(make_ast(curr));
 
 		curr = next_token();
 
 		if (!match_type(curr, TokenType::Identifier)) {
-			throw curr;
-			break;
+			return Diagnostic{ curr };
 		}
-		node_children.push_back(new AST(Token(curr)));
+		node_children.push_back(make_ast(curr));
 		matched_one = true;
 
 		new_node->add_children(node_children);
@@ -499,48 +698,51 @@ std::vector<AST*> Parser::parse_func_args_expr() {
 	}
 
 	if (!matched_one) {
-		exit(-1);
+		return Diagnostic{ curr };
 	}
 
 	return nodes;
 }
 
-AST* Parser::parse_func_call_expr() {
+ParseResult<AST*> Parser::parse_func_call_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 	
 	// the expression isn't a func call
-	if (current_token + 1 > tokens.size() - 1
-		|| tokens[current_token].type != TokenType::Identifier
-		|| tokens[current_token + 1].type != TokenType::LeftParen) {
+	if (tokens.peek_type() != TokenType::Identifier
+		|| tokens.peek_type(1) != TokenType::LeftParen) {
 		return nullptr;
 	}
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* args = new AST("Arguments");
+	AST* args = make_ast("Arguments");
 
 	if (match_type(curr, TokenType::RightParen)) {
 		curr = next_token();
 	}
 	else {
-		std::vector<AST*> args_list = parse_func_args_expr();
-		args->add_children(args_list);
+		ParseResult<std::vector<AST*>> args_list = parse_func_args_expr();
+
+		if (!args_list.ok()) {
+			return args_list.error();
+		}
+		args->add_children(args_list.value());
 
 		curr = peek();
 
 		if (!match_type(curr, TokenType::RightParen)) {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 		curr = next_token();
 	}
@@ -548,264 +750,112 @@ AST* Parser::parse_func_call_expr() {
 	nodes.push_back(args);
 
 	if (match_type(curr, TokenType::Semicolon)) {
-		AST* result = new AST("FuncCallExpr");
+		AST* result = make_ast("FuncCallExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 
-	throw curr;
+	return Diagnostic{ curr };
 }
 
 
-AST* Parser::build_string_tree(std::vector<Token> tokens) {
-	std::stack<Token> ops;
-	std::stack<AST*> trees;
-
-	// special case, string expression without ops
-	if (tokens.size() == 1) {
-		return new AST(tokens[0]);
-	}
-
-	std::vector<TokenType> accepted_types{ TokenType::StringConst,TokenType::Identifier };
-
-	for (int i = 0; i < tokens.size(); i++) {
-		if (match_one_of(tokens[i], accepted_types)) {
-			AST* tree = new AST(tokens[i]);
-			trees.push(tree);
-		}
-		else {
-			ops.push(tokens[i]);
-		}
-	}
-
-	AST* result;
-
-	while (!ops.empty()) {
-		Token op = ops.top();
-		ops.pop();
-
-		std::vector<AST*> children;
-		AST* child1 = new AST(*trees.top());
-		trees.pop();
-		AST* child2 = new AST(*trees.top());
-		trees.pop();
-
-		children.push_back(child2);
-		children.push_back(child1);
-
-		AST* new_tree = new AST(op);
-		new_tree->add_children(children);
-
-		trees.push(new_tree);
-	}
-
-	result = trees.top();
-
-	return result;
-}
-
-AST* Parser::parse_string_expr() {
+ParseResult<AST*> Parser::parse_string_expr() {
 	Token curr = peek();
-	std::vector<Token> tokens;
-
-	bool matched_one = false;
 
-	std::vector<TokenType> accepted_types{ TokenType::StringConst, TokenType::Identifier };
-
-	if (!match_one_of(curr, accepted_types)) {
+	if (!match_type(curr, TokenType::StringConst) && !match_type(curr, TokenType::Identifier)) {
 		return nullptr;
 	}
-	matched_one = true;
-	tokens.push_back(curr);
-	curr = next_token();
+	next_token();
 
-	while (match_type(curr, TokenType::Plus)) {
-		tokens.push_back(curr);
-		curr = next_token();
+	ParseResult<AST*> child = parse_binary(OperatorUse::Concatenation, 0, make_ast(curr));
 
-		if (!match_one_of(curr, accepted_types)) {
-			throw curr;
-		}
-		tokens.push_back(curr);
-		curr = next_token();
+	if (!child.ok()) {
+		return child;
 	}
 
-	AST* child = build_string_tree(tokens);
-	std::vector<AST*> children = { child };
-
-	AST* result = new AST("StringExpr");
-	result->add_children(children);
+	AST* result = make_ast("StringExpr");
+	result->add_child(child.value());
 
 	return result;
 }
 
-AST* Parser::build_logical_tree(std::vector<AST*> trees) {
-	std::stack<AST*> ops;
-	std::stack<AST*> exprs;
+// one comparison, in parentheses of its own or not, the parentheses only show in the trace
+// a ( the comparison leaves open takes in the operators after it up to its )
+ParseResult<AST*> Parser::parse_logical_operand(bool leading) {
+	std::vector<AST*> paren;
+	ParseResult<AST*> parsed = parse_boolean_expr(paren);
 
-	// special case, logical expression without ops and <=
-	if (trees.size() == 1) {
-		return trees[0];
+	if (!parsed.ok()) {
+		return parsed;
 	}
 
-	std::vector<TokenType> accepted_ops{ TokenType::LogicalAnd,TokenType::LogicalOr,
-		TokenType::LeftParen,TokenType::RightParen };
-
-	for (int i = 0; i < trees.size(); i++) {
-		auto root = trees[i]->get_root();
+	AST* tree = parsed.value();
 
-		if (root.index() == 0) {
-			exprs.push(trees[i]);
-			continue;
+	if (tree == nullptr) {
+		if (leading) {
+			return nullptr;
 		}
+		return Diagnostic{ peek() };
+	}
 
-		Token root_value = std::get<Token>(root);
-
-		std::cout << root_value << '\n';
-
-		if (match_one_of(root_value, accepted_ops)) {
-			if (ops.empty() || root_value.type == TokenType::LeftParen) {
-				ops.push(trees[i]);
-			}
-			else {
-				Token top_token = std::get<Token>(ops.top()->get_root());
-
-				if (root_value.type != TokenType::RightParen && top_token.type == TokenType::LeftParen) {
-					ops.push(trees[i]);
-					continue;
-				}
-
-				if (root_value.type == TokenType::RightParen) {
-					while (top_token.type != TokenType::LeftParen) {
-						ops.pop();
-
-						std::vector<AST*> children;
-						AST* child1 = exprs.top();
-						exprs.pop();
-						AST* child2 = exprs.top();
-						exprs.pop();
-
-						children.push_back(child2);
-						children.push_back(child1);
-
-						AST* new_tree = new AST(top_token);
-						new_tree->add_children(children);
-
-						exprs.push(new_tree);
-
-						top_token = std::get<Token>(ops.top()->get_root());
-					}
-					ops.pop(); // removing the (
-					continue;
-				}
-				else if (precedence(root_value) >= precedence(top_token)) {
-					ops.push(trees[i]);
-				}
-				else {
-					AST* ops_top = ops.top();
-					ops.pop();
-
-					std::vector<AST*> children;
-					AST* child1 = exprs.top();
-					exprs.pop();
-					AST* child2 = exprs.top();
-					exprs.pop();
-
-					children.push_back(child1);
-					children.push_back(child2);
-					ops_top->add_children(children);
-
-					exprs.push(ops_top);
-
-					i--; // we will examine the same token from input again
-				}
-			}
-		}
-		else {
-			exprs.push(trees[i]);
+	// a lone comparison isn't traced
+	if (paren.empty()) {
+		if (!leading || joins(peek().type, OperatorUse::Logical)) {
+			trace_root(tree);
 		}
+		return tree;
 	}
 
-	while (!ops.empty()) {
-		AST* ops_top = ops.top();
-		Token root_value = std::get<Token>(ops_top->get_root());
-
-		ops.pop();
-
-		std::vector<AST*> children;
-
-		AST* child1 = exprs.top();
-		exprs.pop();
-		AST* child2 = exprs.top();
-		exprs.pop();
+	trace_root(paren[0]);
+	trace_root(tree);
 
-		children.push_back(child2);
-		children.push_back(child1);
-		ops_top->add_children(children);
-
-		exprs.push(ops_top);
+	if (paren.size() > 1) {
+		trace_root(paren[1]);
+		return tree;
 	}
 
-	AST* result = exprs.top();
+	parsed = parse_binary(OperatorUse::Logical, 0, tree);
 
-	return result;
-}
+	if (!parsed.ok()) {
+		return parsed;
+	}
 
-AST* Parser::parse_logical_expr() {
 	Token curr = peek();
-	std::vector<AST*> children;
-	std::vector<AST*> paren;
-
-	std::cout << "parsing logical\n";
-
-	AST* bool_expr = parse_boolean_expr(paren);
-	bool parsed_one = false;
-
-	while (bool_expr != nullptr) {
-		parsed_one = true;
-
-		int i = 0;
+	if (!match_type(curr, TokenType::RightParen)) {
+		return Diagnostic{ curr };
+	}
+	trace.write<TraceCategory::Expressions, TraceLevel::Debug>(SourceToken{ curr, source, lines }, '\n');
+	next_token();
 
-		while (!paren.empty() && i <= paren.size() - 1 && std::get<Token>(paren[i]->get_root()).type == TokenType::LeftParen) {
-			children.push_back(paren[i]);
-			i++;
-		}
-		children.push_back(bool_expr);
-		while (!paren.empty() && i <= paren.size() - 1 && std::get<Token>(paren[i]->get_root()).type == TokenType::RightParen) {
-			children.push_back(paren[i]);
-			i++;
-		}
-		paren.clear();
+	return parsed;
+}
 
-		curr = peek();
+void Parser::trace_root(AST* tree) {
+	if (Token* token = tree->get_token()) {
+		trace.write<TraceCategory::Expressions, TraceLevel::Debug>(SourceToken{ *token, source, lines }, '\n');
+	}
+}
 
-		std::vector<TokenType> accepted_ops{ TokenType::LogicalAnd,TokenType::LogicalOr };
+ParseResult<AST*> Parser::parse_logical_expr() {
+	trace.write<TraceCategory::Expressions, TraceLevel::Debug>("parsing logical\n");
 
-		if (match_one_of(curr, accepted_ops)) {
-			AST* op = new AST(curr);
-			children.push_back(op);
-			curr = next_token();
-		}
-		else {
-			break;
-		}
+	ParseResult<AST*> child = parse_logical_operand(true);
 
-		bool_expr = parse_boolean_expr(paren);
+	if (!child.ok() || child.value() == nullptr) {
+		return child;
 	}
 
-	if (parsed_one) {
-
-		AST* new_tree = new AST("LogicalExpr");
-		AST* result = build_logical_tree(children);
-
-		std::vector<AST*> child = { result };
-		new_tree->add_children(child);
+	child = parse_binary(OperatorUse::Logical, 0, child.value());
 
-		return new_tree;
+	if (!child.ok()) {
+		return child;
 	}
 
-	return nullptr;
+	AST* result = make_ast("LogicalExpr");
+	result->add_child(child.value());
+
+	return result;
 }
 
 AST* Parser::chain_negations() {
@@ -815,14 +865,13 @@ AST* Parser::chain_negations() {
 	Token curr = peek();
 
 	while (curr.type == TokenType::BitwiseNot) {
-		negations.push_back(new AST(curr));
+		negations.push_back(make_ast(curr));
 		curr = next_token();
 	}
 
 	if (negations.size() > 1) {
 		for (int i = 0; i < negations.size() - 1; i++) {
-			std::vector<AST*> new_child = { negations[i + 1] };
-			negations[i]->add_children(new_child);
+			negations[i]->add_child(negations[i + 1]);
 		}
 		negation = negations[0];
 
@@ -839,14 +888,14 @@ AST* Parser::chain_negations() {
 }
 
 AST* Parser::get_last_node(AST* tree) {
-	while (!tree->get_children().empty()) {
-		tree = tree->get_children()[0];
+	while (tree->child_count() > 0) {
+		tree = tree->get_child(0);
 	}
 
 	return tree;
 }
 
-AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
+ParseResult<AST*> Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 	Token curr = peek();
 	std::vector<AST*> children;
 
@@ -854,7 +903,7 @@ AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 	int close_paren = 0;
 
 	if (match_type(curr, TokenType::LeftParen)) {
-		paren.push_back(new AST(curr));
+		paren.push_back(make_ast(curr));
 		curr = next_token();
 		open_paren++;
 	}
@@ -862,16 +911,20 @@ AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 	AST* negation_tree = chain_negations();
 	curr = peek();
 
-	std::vector<TokenType> accepted_types = {TokenType::True,TokenType::False };
+	ParseResult<AST*> arithmetic = parse_arithmetic_expr();
+
+	if (!arithmetic.ok()) {
+		return arithmetic;
+	}
 
-	AST* lhs = parse_arithmetic_expr();
+	AST* lhs = arithmetic.value();
 
 	if (lhs == nullptr) {
-		if (!match_one_of(curr, accepted_types)) {
+		if (!match_one_of(curr, bool_constants)) {
 			return nullptr;
 		}
 		else {
-			lhs = new AST(curr);
+			lhs = make_ast(curr);
 			curr = next_token();
 		}
 	}
@@ -880,44 +933,43 @@ AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 
 	AST* last_node1 = nullptr;
 	if (negation_tree != nullptr) {
-		std::vector<AST*> new_child = { lhs };
-
 		last_node1 = get_last_node(negation_tree);
-		last_node1->add_children(std::vector<AST*>{ new_child});
+		last_node1->add_child(lhs);
 	}
 
-	std::vector<TokenType> accepted_ops = { TokenType::EqualEqual, TokenType::NotEqual,TokenType::Less,
-	TokenType::LessEqual,TokenType::Greater,TokenType::GreaterEqual,TokenType::LeftShiftEqual };
-
 	AST* op = nullptr;
-	if (match_one_of(curr, accepted_ops)) {
-		op = new AST(curr);
+	if (joins(curr.type, OperatorUse::Relational)) {
+		op = make_ast(curr);
 		curr = next_token();
 	}
 
 	AST* negation_tree2 = chain_negations();
 	curr = peek();
 
-	AST* rhs = parse_arithmetic_expr();
+	arithmetic = parse_arithmetic_expr();
+
+	if (!arithmetic.ok()) {
+		return arithmetic;
+	}
+
+	AST* rhs = arithmetic.value();
 
 	curr = peek();
 
 	if (op != nullptr) {
-		if (rhs == nullptr && !match_one_of(curr, accepted_types)) {
-			throw curr;
+		if (rhs == nullptr && !match_one_of(curr, bool_constants)) {
+			return Diagnostic{ curr };
 		}
-		else if (match_one_of(curr,accepted_types)) {
-			rhs = new AST(curr);
+		else if (match_one_of(curr, bool_constants)) {
+			rhs = make_ast(curr);
 			curr = next_token();
 		}
 	}
 
 	AST* last_node2 = nullptr;
 	if (negation_tree2 != nullptr) {
-		std::vector<AST*> new_child = { rhs };
-
 		last_node2 = get_last_node(negation_tree2);
-		last_node2->add_children(std::vector<AST*>{ new_child});
+		last_node2->add_child(rhs);
 	}
 
 	if (match_type(curr, TokenType::RightParen)) {
@@ -925,7 +977,7 @@ AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 			paren.clear(); // mismatched parens, discard all
 		}
 		else {
-			paren.push_back(new AST(curr));
+			paren.push_back(make_ast(curr));
 			next_token();
 		}
 	}
@@ -955,17 +1007,12 @@ AST* Parser::parse_boolean_expr(std::vector<AST*>& paren) {
 	return op;
 }
 
-AST* Parser::parse_simple_assignment_expr() {
+ParseResult<AST*> Parser::parse_simple_assignment_expr() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
-	std::vector<TokenType> accepted_ops = { TokenType::Equal, TokenType::StarEqual,TokenType::DivideEqual,
-	TokenType::ModuloEqual,TokenType::PlusEqual,TokenType::MinusEqual,TokenType::LeftShiftEqual,
-	TokenType::RightShiftEqual,TokenType::BitwiseAndEqual,TokenType::BitwiseXorEqual, TokenType::BitwiseOrEqual };
-
 	// the expression isn't an assignment
-	if (current_token + 1 > tokens.size() - 1
-		|| !match_one_of(tokens[current_token + 1], accepted_ops)) {
+	if (!match_one_of(tokens.peek(1), assignment_operators)) {
 		return nullptr;
 	}
 
@@ -973,83 +1020,81 @@ AST* Parser::parse_simple_assignment_expr() {
 		return nullptr;
 	}
 
-	AST* lhs = new AST(curr);
+	AST* lhs = make_ast(curr);
 	curr = next_token();
 
-	if (!match_one_of(curr, accepted_ops)) {
-		throw curr;
+	if (!match_one_of(curr, assignment_operators)) {
+		return Diagnostic{ curr };
 	}
 
-	AST* op = new AST(curr);
+	AST* op = make_ast(curr);
 	curr = next_token();
 
-	AST* rhs = nullptr;
-	rhs = parse_arithmetic_expr();
+	ParseResult<AST*> rhs = parse_arithmetic_expr();
 
-	if (rhs == nullptr) {
+	if (rhs.ok() && rhs.value() == nullptr) {
 		rhs = parse_string_expr();
 	}
-	if (rhs == nullptr) {
+	if (rhs.ok() && rhs.value() == nullptr) {
 		rhs = parse_logical_expr();
 	}
-	if (rhs == nullptr && match_type(curr, TokenType::CharConst)) {
-		AST* rhs = new AST(curr);
+	if (!rhs.ok()) {
+		return rhs;
+	}
+	if (rhs.value() == nullptr && match_type(curr, TokenType::CharConst)) {
+		rhs = make_ast(curr);
+		curr = next_token();
 	}
 
-	if (rhs != nullptr) {
+	if (rhs.value() != nullptr) {
 		children.push_back(lhs);
-		children.push_back(rhs);
+		children.push_back(rhs.value());
 		op->add_children(children);
 
-		AST* result = new AST("AssignExpr");
-		std::vector<AST*> child = { op };
-		result->add_children(child);
+		AST* result = make_ast("AssignExpr");
+		result->add_child(op);
 
 		return result;
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 }
 
-AST* Parser::parse_decl_assignment_expr() {
+ParseResult<AST*> Parser::parse_decl_assignment_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 	std::vector<AST*> lhs_children;
 
 	TokenType matched_type;
 
-	std::vector<TokenType> accepted_types{ TokenType::IntegerType,TokenType::FloatType,
-	TokenType::String,TokenType::Unsigned,TokenType::Bool,TokenType::Char };
-
 	// the expression isn't an assignment
-	if (current_token + 2 > tokens.size() - 1
-		|| tokens[current_token+2].type != TokenType::Equal) {
+	if (tokens.peek_type(2) != TokenType::Equal) {
 		return nullptr;
 	}
 
-	if (!match_one_of(curr, accepted_types)) {
+	if (!match_one_of(curr, type_names)) {
 		return nullptr;
 	}
 	else {
 		matched_type = curr.type;
-		lhs_children.push_back(new AST(curr));
+		lhs_children.push_back(make_ast(curr));
 		curr = next_token();
 	}
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	lhs_children.push_back(new AST(curr));
+	lhs_children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Equal)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	AST* op = new AST(curr);
+	AST* op = make_ast(curr);
 
 	curr = next_token();
-	AST* rhs = nullptr;
+	ParseResult<AST*> rhs = nullptr;
 
 	if (matched_type == TokenType::IntegerType || matched_type == TokenType::FloatType
 		|| matched_type == TokenType::Unsigned) {
@@ -1059,445 +1104,385 @@ AST* Parser::parse_decl_assignment_expr() {
 		rhs = parse_string_expr();
 	}
 	else if (matched_type == TokenType::Char && curr.type == TokenType::CharConst) {
-		rhs = new AST(Token(curr));
+		rhs = make_ast(curr);
 		next_token();
 	}
 	else if (matched_type == TokenType::Bool) {
 		rhs = parse_logical_expr();
-	}
-
-	if (rhs == nullptr) {
-		throw curr;
-	}
-
-	AST* result = new AST("AssignExpr");
-
-	AST* lhs = new AST("LHS");
-	lhs->add_children(lhs_children);
-
-	nodes.push_back(lhs);
-	nodes.push_back(rhs);
-
-	op->add_children(nodes);
-	std::vector<AST*> child = { op };
-	result->add_children(child);
-
-	return result;
-}
-
-AST* Parser::parse_input_expr() {
-	Token curr = peek();
-	std::vector<AST*> children;
-
-	if (!match_type(curr, TokenType::Cin)) {
-		return nullptr;
-	}
-	children.push_back(new AST(curr));
-	curr = next_token();
-
-	bool parsed_one = false;
-
-	while (match_type(curr, TokenType::RightShift)) {
-
-		AST* op = new AST(curr);
-		children.push_back(op);
-		curr = next_token();
-
-		if (!match_type(curr, TokenType::Identifier)) {
-			throw curr;
-			break;
-		}
-		children.push_back(new AST(curr));
-		curr = next_token();
-
-		parsed_one = true;
-	}
-
-	if (parsed_one) {
-		AST* new_tree = new AST("InputExpr");
-		AST* result = build_io_tree(children);
-
-		std::vector<AST*> child = { result };
-		new_tree->add_children(child);
-
-		return new_tree;
-	}
-
-	return nullptr;
-}
-
-AST* Parser::parse_output_expr() {
-	Token curr = peek();
-	std::vector<AST*> children;
-
-	if (!match_type(curr, TokenType::Cout)) {
-		return nullptr;
-	}
-	children.push_back(new AST(curr));
-	curr = next_token();
-
-	bool parsed_one = false;
-
-	while (match_type(curr, TokenType::LeftShift)) {
-
-		AST* op = new AST(curr);
-		children.push_back(op);
-		curr = next_token();
-
-		AST* str_expr = parse_string_expr();
-
-		if (str_expr != nullptr) {
-			children.push_back(str_expr);
-			curr = peek();
-		}
-		else if(match_type(curr,TokenType::CharConst)) {
-			children.push_back(new AST(Token(curr)));
-			curr = next_token();
-		}
-		else if (match_type(curr, TokenType::Identifier)) {
-			children.push_back(new AST(Token(curr)));
-			curr = next_token();
-		}
-		else {
-			throw curr;
-			break;
-		}
+	}
 
-		parsed_one = true;
+	if (!rhs.ok()) {
+		return rhs;
 	}
 
-	if (parsed_one) {
-		AST* new_tree = new AST("OutputExpr");
-		AST* result = build_io_tree(children);
+	if (rhs.value() == nullptr) {
+		return Diagnostic{ curr };
+	}
 
-		std::vector<AST*> child = { result };
-		new_tree->add_children(child);
+	AST* result = make_ast("AssignExpr");
 
-		std::cout << peek() << '\n';
+	AST* lhs = make_ast("LHS");
+	lhs->add_children(lhs_children);
 
-		return new_tree;
-	}
+	nodes.push_back(lhs);
+	nodes.push_back(rhs.value());
+
+	op->add_children(nodes);
+	result->add_child(op);
 
-	return nullptr;
+	return result;
 }
 
-AST* Parser::build_io_tree(std::vector<AST*> trees) {
-	std::stack<AST*> ops;
-	std::stack<AST*> exprs;
+ParseResult<AST*> Parser::parse_input_expr() {
+	Token curr = peek();
 
-	std::vector<TokenType> accepted_ops{ TokenType::RightShift,TokenType::LeftShift };
+	if (!match_type(curr, TokenType::Cin)) {
+		return nullptr;
+	}
+	AST* cin = make_ast(curr);
+	curr = next_token();
 
-	for (int i = 0; i < trees.size(); i++) {
-		auto root = trees[i]->get_root();
+	if (!match_type(curr, TokenType::RightShift)) {
+		return nullptr;
+	}
 
-		if (root.index() == 1) {
-			Token root_value = std::get<Token>(root);
+	ParseResult<AST*> child = parse_binary(OperatorUse::Input, 0, cin);
 
-			if (match_one_of(root_value, accepted_ops)) {
-				ops.push(trees[i]);
-			}
-			else {
-				exprs.push(trees[i]);
-			}
-		}
-		else {
-			exprs.push(trees[i]);
-		}
+	if (!child.ok()) {
+		return child;
 	}
 
-	while (!ops.empty()) {
-		AST* ops_top = ops.top();
-		Token root_value = std::get<Token>(ops_top->get_root());
+	AST* result = make_ast("InputExpr");
+	result->add_child(child.value());
+
+	return result;
+}
 
-		ops.pop();
+ParseResult<AST*> Parser::parse_output_expr() {
+	Token curr = peek();
 
-		std::vector<AST*> children;
+	if (!match_type(curr, TokenType::Cout)) {
+		return nullptr;
+	}
+	AST* cout = make_ast(curr);
+	curr = next_token();
 
-		AST* child1 = exprs.top();
-		exprs.pop();
-		AST* child2 = exprs.top();
-		exprs.pop();
+	if (!match_type(curr, TokenType::LeftShift)) {
+		return nullptr;
+	}
 
-		children.push_back(child2);
-		children.push_back(child1);
-		ops_top->add_children(children);
+	ParseResult<AST*> child = parse_binary(OperatorUse::Output, 0, cout);
 
-		exprs.push(ops_top);
+	if (!child.ok()) {
+		return child;
 	}
 
-	AST* result = exprs.top();
+	AST* result = make_ast("OutputExpr");
+	result->add_child(child.value());
+
+	trace.write<TraceCategory::Expressions, TraceLevel::Debug>(SourceToken{ peek(), source, lines }, '\n');
 
 	return result;
 }
 
-AST* Parser::parse_for_expr() {
+ParseResult<AST*> Parser::parse_for_expr() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
 	if (!match_type(curr, TokenType::For)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* init_expr = parse_decl_assignment_expr();
+	ParseResult<AST*> init_expr = parse_decl_assignment_expr();
 
-	if (init_expr == nullptr) {
+	if (init_expr.ok() && init_expr.value() == nullptr) {
 		init_expr = parse_simple_assignment_expr();
+	}
 
-		if (init_expr != nullptr) {
-			children.push_back(init_expr);
-		}
+	if (!init_expr.ok()) {
+		return init_expr;
 	}
-	else {
-		children.push_back(init_expr);
+
+	if (init_expr.value() != nullptr) {
+		children.push_back(init_expr.value());
 	}
 
 	curr = peek();
 	if (!match_type(curr, TokenType::Semicolon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* cond_expr = parse_logical_expr();
+	ParseResult<AST*> cond_expr = parse_logical_expr();
+
+	if (!cond_expr.ok()) {
+		return cond_expr;
+	}
 
-	if (cond_expr == nullptr) {
-		throw curr;
+	if (cond_expr.value() == nullptr) {
+		return Diagnostic{ curr };
 	}
 	else {
-		children.push_back(cond_expr);
+		children.push_back(cond_expr.value());
 	}
 
 	curr = peek();
 	if (!match_type(curr, TokenType::Semicolon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* incr_expr = parse_incr_decr_expr();
-	if (incr_expr == nullptr) {
+	ParseResult<AST*> incr_expr = parse_incr_decr_expr();
+
+	if (incr_expr.ok() && incr_expr.value() == nullptr) {
 		incr_expr = parse_simple_assignment_expr();
+	}
 
-		if (incr_expr != nullptr) {
-			children.push_back(incr_expr);
-		}
+	if (!incr_expr.ok()) {
+		return incr_expr;
 	}
-	else {
-		children.push_back(incr_expr);
+
+	if (incr_expr.value() != nullptr) {
+		children.push_back(incr_expr.value());
 	}
 
 	curr = peek();
 
 	if (!match_type(curr, TokenType::RightParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftBrace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* body = parse_braces_body("ForBody");
+	ParseResult<AST*> body = parse_braces_body("ForBody");
+
+	if (!body.ok()) {
+		return body;
+	}
 
-	if (body != nullptr) {
-		children.push_back(body);
+	if (body.value() != nullptr) {
+		children.push_back(body.value());
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
-	AST* result = new AST("ForExpr");
+	AST* result = make_ast("ForExpr");
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_class_definition_expr() {
+ParseResult<AST*> Parser::parse_class_definition_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
-	std::vector<TokenType> accepted_types{TokenType::Class,TokenType::Struct };
-
-	if (!match_one_of(curr, accepted_types)) {
+	if (!match_one_of(curr, class_keys)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (match_type(curr, TokenType::Semicolon)) {
-		AST* result = new AST("ClassDeclExpr");
+		AST* result = make_ast("ClassDeclExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 	else if (match_type(curr, TokenType::LeftBrace)) {
 		next_token();
-		AST* body = parse_class_body();
+		ParseResult<AST*> body = parse_class_body();
 
-		if (body != nullptr) {
-			nodes.push_back(body);
+		if (!body.ok()) {
+			return body;
+		}
+
+		if (body.value() != nullptr) {
+			nodes.push_back(body.value());
 		}
 		else {
 			curr = peek();
-			throw curr;
+			return Diagnostic{ curr };
 		}
 
-		AST* result = new AST("ClassDefExpr");
+		AST* result = make_ast("ClassDefExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 
-	throw curr;
+	return Diagnostic{ curr };
 }
 
 // after parsed body token is the one after }
-AST* Parser::parse_class_body() {
+ParseResult<AST*> Parser::parse_class_body() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
 	while (!match_type(curr, TokenType::RightBrace)) {
-		AST* node = nullptr;
-
 		curr = peek();
 
-		if (current_token == tokens.size() - 1) {
-			throw curr;
-			break;
+		if (finished_parsing()) {
+			return Diagnostic{ curr };
 		}
 
 		if (match_type(curr, TokenType::NewLine)) {
 			next_token();
 			continue;
 		}
-		
-		try { node = parse_access_specifier_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
 
-		if (node != nullptr) {
-			children.push_back(node);
+		size_t before = tokens.consumed();
+
+		// each one is tried in turn, the ones after a member that doesn't parse are not
+		ParseResult<AST*> node = parse_access_specifier_expr();
+
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			//next_token();
 		}
 
-		try { node = parse_class_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		if (node.ok()) {
+			node = parse_class_definition_expr();
+		}
 
-		if (node != nullptr) {
-			children.push_back(node);
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			//next_token();
 		}
 
-		try { node = parse_var_declaration_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		if (node.ok()) {
+			node = parse_var_declaration_expr();
+		}
 
-		if (node != nullptr) {
-			children.push_back(node);
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			//next_token();
 		}
 
-		try { node = parse_func_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		if (node.ok()) {
+			node = parse_func_definition_expr();
+		}
 
-		if (node != nullptr) {
-			children.push_back(node);
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			//next_token();
 		}
 
-		try { node = parse_class_constructor_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		if (node.ok()) {
+			node = parse_class_constructor_expr();
+		}
 
-		if (node != nullptr) {
-			children.push_back(node);
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			next_token();
 		}
 
-		try { node = parse_class_destructor_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		if (node.ok()) {
+			node = parse_class_destructor_expr();
+		}
 
-		if (node != nullptr) {
-			children.push_back(node);
+		if (node.ok() && node.value() != nullptr) {
+			children.push_back(node.value());
 			next_token();
 		}
+
+		if (!node.ok()) {
+			report(node.error());
+			skip_statement();
+		}
+		// no member starts here
+		else if (tokens.consumed() == before && !match_type(curr, TokenType::RightBrace)) {
+			report(Diagnostic{ curr });
+			skip_statement();
+		}
 	}
 
 	if (match_type(curr, TokenType::RightBrace)) {
 		next_token();
 	}
 
-	AST* result = new AST("ClassBody");
+	AST* result = make_ast("ClassBody");
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_access_specifier_expr() {
+ParseResult<AST*> Parser::parse_access_specifier_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::AccessSpecifier)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Colon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* result = new AST("AccessSpecExpr");
+	AST* result = make_ast("AccessSpecExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-AST* Parser::parse_class_constructor_expr() {
+ParseResult<AST*> Parser::parse_class_constructor_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	// the expression isn't a constructor
-	if (current_token + 1 > tokens.size() - 1
-		|| tokens[current_token].type != TokenType::Identifier
-		|| tokens[current_token + 1].type != TokenType::LeftParen) {
+	if (tokens.peek_type() != TokenType::Identifier
+		|| tokens.peek_type(1) != TokenType::LeftParen) {
 		return nullptr;
 	}
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* args = new AST("Arguments");
+	AST* args = make_ast("Arguments");
 
 	if (match_type(curr, TokenType::RightParen)) {
 		curr = next_token();
 	}
 	else {
-		std::vector<AST*> args_list = parse_func_args_expr();
-		args->add_children(args_list);
+		ParseResult<std::vector<AST*>> args_list = parse_func_args_expr();
+
+		if (!args_list.ok()) {
+			return args_list.error();
+		}
+		args->add_children(args_list.value());
 
 		curr = peek();
 
 		if (!match_type(curr, TokenType::RightParen)) {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 		curr = next_token();
 	}
@@ -1514,58 +1499,64 @@ AST* Parser::parse_class_constructor_expr() {
 				continue;
 			}
 
-			AST* node = parse_simple_assignment_expr();
+			ParseResult<AST*> node = parse_simple_assignment_expr();
 
-			if (node != nullptr) {
-				curr = peek();
-				if (match_type(curr, TokenType::Semicolon)) {
-					nodes.push_back(node);
-					curr = next_token();
-				}
-				else {
-					throw curr;
-					exit(-1);
-				}
+			if (!node.ok()) {
+				return node;
+			}
+
+			// anything else would be looked at again and again
+			if (node.value() == nullptr) {
+				return Diagnostic{ curr };
+			}
+
+			curr = peek();
+			if (match_type(curr, TokenType::Semicolon)) {
+				nodes.push_back(node.value());
+				curr = next_token();
+			}
+			else {
+				return Diagnostic{ curr };
 			}
 		}
 
-		AST* result = new AST("ClassConstrExpr");
+		AST* result = make_ast("ClassConstrExpr");
 		result->add_children(nodes);
 
 		return result;
 	}
 
-	throw curr;
+	return Diagnostic{ curr };
 }
 
-AST* Parser::parse_class_destructor_expr() {
+ParseResult<AST*> Parser::parse_class_destructor_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::Tilde)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::RightParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftBrace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
@@ -1575,70 +1566,70 @@ AST* Parser::parse_class_destructor_expr() {
 			continue;
 		}
 
-		AST* node = parse_delete_expr();
+		ParseResult<AST*> node = parse_delete_expr();
 
-		if (node == nullptr) {
-			throw curr;
-			exit(-1);
+		if (!node.ok()) {
+			return node;
+		}
+
+		if (node.value() == nullptr) {
+			return Diagnostic{ curr };
 		}
 		else {
-			nodes.push_back(node);
+			nodes.push_back(node.value());
 			curr = next_token();
 		}
 	}
 
-	AST* result = new AST("ClassDestrExpr");
+	AST* result = make_ast("ClassDestrExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
-AST* Parser::parse_delete_expr() {
+ParseResult<AST*> Parser::parse_delete_expr() {
 	Token curr = peek();
 	std::vector<AST*> nodes;
 
 	if (!match_type(curr, TokenType::Delete)) {
 		return nullptr;
 	}
-	nodes.push_back(new AST(Token(curr)));
+	nodes.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (match_type(curr, TokenType::BracketOperator)) {
-		nodes.push_back(new AST(Token(curr)));
+		nodes.push_back(make_ast(curr));
 		curr = next_token();
 	}
 
 	if (!match_type(curr, TokenType::Identifier)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::Semicolon)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* result = new AST("DeleteExpr");
+	AST* result = make_ast("DeleteExpr");
 	result->add_children(nodes);
 
 	return result;
 }
 
 // after parsed body token is the one after }
-AST* Parser::parse_braces_body(const std::string& str) {
+ParseResult<AST*> Parser::parse_braces_body(std::string_view str) {
 	Token curr = peek();
 	std::vector<AST*> children;
 
-	std::cout << "in braces " << peek() << '\n';
+	trace.write<TraceCategory::Statements, TraceLevel::Info>("in braces ", SourceToken{ peek(), source, lines }, '\n');
 
 	while (!match_type(curr, TokenType::RightBrace)) {
-		AST* node = nullptr;
-		
 		curr = peek();
 
-		if (current_token == tokens.size() - 1) {
-			throw curr;
-			break;
+		if (finished_parsing()) {
+			return Diagnostic{ curr };
 		}
 
 		if (match_type(curr, TokenType::NewLine)) {
@@ -1646,140 +1637,34 @@ AST* Parser::parse_braces_body(const std::string& str) {
 			continue;
 		}
 
-		try { node = parse_output_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
-
-			children.push_back(node);
-			next_token();
-
-			std::cout << peek();
-		}
-
-		try { node = parse_input_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
-
-			children.push_back(node);
-			next_token();
-		}
-
-		try { node = parse_return_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
-
-			children.push_back(node);
-			next_token();
-		}
-
-		try { node = parse_var_declaration_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			children.push_back(node);
-		}
-
-		try { node = parse_decl_assignment_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
-
-			children.push_back(node);
-			next_token();
-		}
-
-		try { node = parse_simple_assignment_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
-
-			children.push_back(node);
-			next_token();
-		}
-
-		try { node = parse_if_else_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			children.push_back(node);
-			//next_token();
-		}
-
-		try { node = parse_for_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			children.push_back(node);
-			//next_token();
-		}
-
-		try { node = parse_func_call_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			children.push_back(node);
-			next_token();
-		}
-
-		try { node = parse_func_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (node != nullptr) {
-			children.push_back(node);
-			//next_token();
-		}
-
-		try { node = parse_class_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+		size_t before = tokens.consumed();
+		parse_statements(braces_rules(), children);
 
-		if (node != nullptr) {
-			children.push_back(node);
-			next_token();
+		// nothing in a body starts with this token
+		if (tokens.consumed() == before && !match_type(curr, TokenType::RightBrace)) {
+			report(Diagnostic{ curr });
+			skip_statement();
 		}
 	}
 
 	curr = peek();
 
-	std::cout << peek() << '\n';
+	trace.write<TraceCategory::Statements, TraceLevel::Info>(SourceToken{ peek(), source, lines }, '\n');
 
 	if (curr.type == TokenType::RightBrace) {
 		next_token();
 	}
 	else {
-		throw curr;
-		exit(-1);
+		return Diagnostic{ curr };
 	}
 
-	AST* result = new AST(str);
+	AST* result = make_ast(str);
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_incr_decr_expr() {
+ParseResult<AST*> Parser::parse_incr_decr_expr() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
@@ -1787,15 +1672,15 @@ AST* Parser::parse_incr_decr_expr() {
 	bool plus = false;
 
 	if (match_type(curr, TokenType::Identifier)) {
-		children.push_back(new AST(Token(curr)));
+		children.push_back(make_ast(curr));
 	}
 	else if (match_type(curr, TokenType::PlusPlus)) {
-		children.push_back(new AST(Token(curr)));
+		children.push_back(make_ast(curr));
 		prefix = true;
 		plus = true;
 	}
 	else if (match_type(curr, TokenType::MinusMinus)) {
-		children.push_back(new AST(Token(curr)));
+		children.push_back(make_ast(curr));
 		prefix = true;
 	}
 	else {
@@ -1806,31 +1691,31 @@ AST* Parser::parse_incr_decr_expr() {
 
 	if (prefix) {
 		if (!match_type(curr, TokenType::Identifier)) {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 		else {
-			children.push_back(new AST(Token(curr)));
+			children.push_back(make_ast(curr));
 		}
 	}
 	else if (match_type(curr, TokenType::PlusPlus)) {
-		children.push_back(new AST(Token(curr)));
+		children.push_back(make_ast(curr));
 		plus = true;
 		next_token();
 	}
 	else if (match_type(curr, TokenType::MinusMinus)) {
-		children.push_back(new AST(Token(curr)));
+		children.push_back(make_ast(curr));
 		next_token();
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
 	AST* result;
 	if (plus) {
-		result = new AST("IncrExpr");
+		result = make_ast("IncrExpr");
 	}
 	else {
-		result = new AST("DecrExpr");
+		result = make_ast("DecrExpr");
 	}
 
 	result->add_children(children);
@@ -1838,60 +1723,68 @@ AST* Parser::parse_incr_decr_expr() {
 	return result;
 }
 
-AST* Parser::parse_while_expr() {
+ParseResult<AST*> Parser::parse_while_expr() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
 	if (!match_type(curr, TokenType::While)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
-	std::cout << "parsing while\n";
+	trace.write<TraceCategory::Statements, TraceLevel::Info>("parsing while\n");
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* cond_expr = parse_logical_expr();
+	ParseResult<AST*> cond_expr = parse_logical_expr();
+
+	if (!cond_expr.ok()) {
+		return cond_expr;
+	}
 
-	if (cond_expr == nullptr) {
-		throw curr;
+	if (cond_expr.value() == nullptr) {
+		return Diagnostic{ curr };
 	}
 	else {
-		children.push_back(cond_expr);
+		children.push_back(cond_expr.value());
 	}
 
 	curr = peek();
 
 	if (!match_type(curr, TokenType::RightParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftBrace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* body = parse_braces_body("WhileBody");
+	ParseResult<AST*> body = parse_braces_body("WhileBody");
+
+	if (!body.ok()) {
+		return body;
+	}
 
-	if (body != nullptr) {
-		children.push_back(body);
+	if (body.value() != nullptr) {
+		children.push_back(body.value());
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
-	AST* result = new AST("WhileExpr");
+	AST* result = make_ast("WhileExpr");
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_if_else_expr() {
+ParseResult<AST*> Parser::parse_if_else_expr() {
 	Token curr = peek();
 
 	std::vector<AST*> children;
@@ -1905,41 +1798,49 @@ AST* Parser::parse_if_else_expr() {
 	if (!match_type(curr, TokenType::If)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* cond_expr = parse_logical_expr();
+	ParseResult<AST*> cond_expr = parse_logical_expr();
+
+	if (!cond_expr.ok()) {
+		return cond_expr;
+	}
 
-	if (cond_expr == nullptr) {
-		throw curr;
+	if (cond_expr.value() == nullptr) {
+		return Diagnostic{ curr };
 	}
 	else {
-		if_children.push_back(cond_expr);
+		if_children.push_back(cond_expr.value());
 	}
 
 	curr = peek();
 	if (!match_type(curr, TokenType::RightParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftBrace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* body = parse_braces_body("IfBody");
+	ParseResult<AST*> body = parse_braces_body("IfBody");
+
+	if (!body.ok()) {
+		return body;
+	}
 
-	if (body != nullptr) {
-		if_children.push_back(body);
+	if (body.value() != nullptr) {
+		if_children.push_back(body.value());
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
 	curr = peek();
@@ -1947,15 +1848,18 @@ AST* Parser::parse_if_else_expr() {
 		curr = next_token();
 	}
 
-	AST* else_if = parse_else_if();
+	ParseResult<AST*> else_if = parse_else_if();
 	bool parsed_one = false;
+
+	if (!else_if.ok()) {
+		return else_if;
+	}
 	
-	while (else_if != nullptr) {
+	while (else_if.value() != nullptr) {
 		curr = peek();
 
-		if (current_token == tokens.size() - 1) {
-			throw curr;
-			break;
+		if (finished_parsing()) {
+			return Diagnostic{ curr };
 		}
 
 		if (match_type(curr, TokenType::NewLine)) {
@@ -1965,13 +1869,17 @@ AST* Parser::parse_if_else_expr() {
 
 		parsed_one = true;
 		has_else_if = true;
-		else_if_children.push_back(else_if);
+		else_if_children.push_back(else_if.value());
 
 		else_if = parse_else_if();
+
+		if (!else_if.ok()) {
+			return else_if;
+		}
 	}
 
 	if (parsed_one) {
-		children.push_back(new AST("ElseIfExprs"));
+		children.push_back(make_ast("ElseIfExprs"));
 	}
 
 	curr = peek();
@@ -1983,347 +1891,266 @@ AST* Parser::parse_if_else_expr() {
 	if (match_type(curr, TokenType::Else)) {
 		has_else = true;
 
-		children.push_back(new AST(curr));
+		children.push_back(make_ast(curr));
 		curr = next_token();
 
 		if (match_type(curr, TokenType::LeftBrace)) {
 			curr = next_token();
 
-			AST* body2 = parse_braces_body("ElseBody");
+			ParseResult<AST*> body2 = parse_braces_body("ElseBody");
+
+			if (!body2.ok()) {
+				return body2;
+			}
 
-			if (body2 != nullptr) {
-				else_children.push_back(body2);
+			if (body2.value() != nullptr) {
+				else_children.push_back(body2.value());
 			}
 			else {
-				throw curr;
+				return Diagnostic{ curr };
 			}
 		}
 		else {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 	}
 
-	AST* result = new AST("IfElseExpr");
+	AST* result = make_ast("IfElseExpr");
 	result->add_children(children);
 
-	result->get_children()[0]->add_children(if_children);
+	result->get_child(0)->add_children(if_children);
 	if (has_else_if && has_else) {
-		result->get_children()[1]->add_children(else_if_children);
-		result->get_children()[2]->add_children(else_children);
+		result->get_child(1)->add_children(else_if_children);
+		result->get_child(2)->add_children(else_children);
 	}
 	else if (!has_else_if && has_else) {
-		result->get_children()[1]->add_children(else_children);
+		result->get_child(1)->add_children(else_children);
 	}
 
 	return result;
 }
 
-AST* Parser::parse_else_if() {
+ParseResult<AST*> Parser::parse_else_if() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
 	// check if its an else if expression
-	if (current_token + 1 > tokens.size() - 1 ||
-		tokens[current_token].type != TokenType::Else ||
-		tokens[current_token + 1].type != TokenType::If) {
+	if (tokens.peek_type() != TokenType::Else ||
+		tokens.peek_type(1) != TokenType::If) {
 		return nullptr;
 	}
 
 	if (!match_type(curr, TokenType::Else)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	children.push_back(new AST(Token(curr)));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::If)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
-	children.push_back(new AST(Token(curr)));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if(!match_type(curr, TokenType::LeftParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* cond_expr = parse_logical_expr();
+	ParseResult<AST*> cond_expr = parse_logical_expr();
+
+	if (!cond_expr.ok()) {
+		return cond_expr;
+	}
 
-	if (cond_expr == nullptr) {
-		throw curr;
+	if (cond_expr.value() == nullptr) {
+		return Diagnostic{ curr };
 	}
 	else {
-		children.push_back(cond_expr);
+		children.push_back(cond_expr.value());
 	}
 
 	curr = peek();
 	if (!match_type(curr, TokenType::RightParen)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
 	if (!match_type(curr, TokenType::LeftBrace)) {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 	curr = next_token();
 
-	AST* body = parse_braces_body("ElseIfBody");
+	ParseResult<AST*> body = parse_braces_body("ElseIfBody");
+
+	if (!body.ok()) {
+		return body;
+	}
 
-	if (body != nullptr) {
-		children.push_back(body);
+	if (body.value() != nullptr) {
+		children.push_back(body.value());
 	}
 	else {
-		throw curr;
+		return Diagnostic{ curr };
 	}
 
-	AST* result = new AST("ElseIfExpr");
+	AST* result = make_ast("ElseIfExpr");
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_return_expr() {
+ParseResult<AST*> Parser::parse_return_expr() {
 	Token curr = peek();
 	std::vector<AST*> children;
 
 	if (!match_type(curr, TokenType::Return)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
+	children.push_back(make_ast(curr));
 	curr = next_token();
 
 	if (match_type(curr, TokenType::Identifier)) {
-		children.push_back(new AST(curr));
+		children.push_back(make_ast(curr));
 		curr = next_token();
 	}
 	else {
-		AST* expr = parse_arithmetic_expr();
+		ParseResult<AST*> expr = parse_arithmetic_expr();
 
-		if (expr == nullptr) {
+		if (expr.ok() && expr.value() == nullptr) {
 			expr = parse_logical_expr();
 		}
 
-		if (expr == nullptr) {
+		if (expr.ok() && expr.value() == nullptr) {
 			expr = parse_string_expr();
 		}
 
-		if (expr != nullptr) {
-			children.push_back(expr);
+		if (!expr.ok()) {
+			return expr;
+		}
+
+		if (expr.value() != nullptr) {
+			children.push_back(expr.value());
 		}
 		else {
-			throw curr;
+			return Diagnostic{ curr };
 		}
 	}
 
-	AST* result = new AST("ReturnExpr");
+	AST* result = make_ast("ReturnExpr");
 	result->add_children(children);
 
 	return result;
 }
 
-AST* Parser::parse_line_comment() {
+// the lexer hands over a whole comment as one token
+ParseResult<AST*> Parser::parse_line_comment() {
 	Token curr = peek();
-	std::vector<AST*> children;
 
 	if (!match_type(curr, TokenType::LineComment)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
-	curr = next_token();
-
-	while (!match_type(curr, TokenType::NewLine)) {
-		children.push_back(new AST(curr));
-		curr = next_token();
-	}
 
-	AST* result = new AST("LineComment");
-	result->add_children(children);
+	AST* result = make_ast("LineComment");
+	result->add_child(make_ast(curr));
 
 	return result;
 }
 
-AST* Parser::parse_multiline_comment() {
+ParseResult<AST*> Parser::parse_multiline_comment() {
 	Token curr = peek();
-	std::vector<AST*> children;
 
-	if (!match_type(curr, TokenType::MultilineCommentStart)) {
+	if (!match_type(curr, TokenType::MultilineComment)) {
 		return nullptr;
 	}
-	children.push_back(new AST(curr));
-	curr = next_token();
-
-	while (!match_type(curr, TokenType::MultilineCommentEnd)) {
-		children.push_back(new AST(curr));
-		curr = next_token();
-	}
 
-	AST* result = new AST("MultilineComment");
-	result->add_children(children);
+	AST* result = make_ast("MultilineComment");
+	result->add_child(make_ast(curr));
 
 	return result;
 }
 
-void Parser::parse_code(AST* tree) {
-	while (!finished_parsing()) {
-		AST* new_node = nullptr;
-
-		Token curr = peek();
-
-		std::cout << curr << '\n';
-
-		if (curr.type == TokenType::NewLine) {
-			next_token();
-			continue;
-		}
-
-		try { new_node = parse_line_comment(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
-
-		try { new_node = parse_multiline_comment(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
-
-		try { new_node = parse_include_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
-
-		try { new_node = parse_using_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
-
-		try { new_node = parse_var_declaration_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			//next_token();
-		}
-
-		try { new_node = parse_decl_assignment_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+// a body that runs into the end of the input stops there and so does each one around it, that is one error
+// repeats are only dropped within one top-level item so what an item reports doesn't depend on the items before it
+void Parser::report(const Diagnostic& diagnostic) {
+	if (diagnostics.size() > item_diagnostics && diagnostics.back().token.type == diagnostic.token.type
+		&& diagnostics.back().token.offset == diagnostic.token.offset) {
+		return;
+	}
 
-		if (new_node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
+	diagnostics.push_back(diagnostic);
+}
 
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
+// skips the rest of a statement that didn't parse, up to and past the ; that ends it or the } of a block
+// it opened, a } that closes the body around it is left for the body, gives whether it moved at all
+bool Parser::skip_statement() {
+	size_t depth = 0;
+	bool moved = false;
 
-		try { new_node = parse_simple_assignment_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+	while (!finished_parsing()) {
+		TokenType type = tokens.peek_type();
 
-		if (new_node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
+		if (type == TokenType::RightBrace) {
+			if (depth == 0) {
+				return moved;
 			}
-
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
+			depth--;
 		}
-
-		try { new_node = parse_func_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-		}
-
-		try { new_node = parse_func_call_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
+		else if (type == TokenType::LeftBrace) {
+			depth++;
 		}
 
-		try { new_node = parse_input_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
+		next_token();
+		moved = true;
 
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
+		if (depth == 0 && (type == TokenType::Semicolon || type == TokenType::RightBrace)) {
+			return true;
 		}
+	}
 
-		try { new_node = parse_output_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
+	return moved;
+}
 
-			tree->add_children(std::vector<AST*> {new_node});
-			next_token();
-		}
+const std::vector<Diagnostic>& Parser::get_diagnostics() const {
+	return diagnostics;
+}
 
-		try { new_node = parse_for_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+void print_diagnostics(const std::vector<Diagnostic>& diagnostics, const LineTable& lines, std::ostream& out) {
+	for (const Diagnostic& diagnostic : diagnostics) {
+		out << "error on " << position_of(diagnostic.token, lines) << '\n';
+	}
+}
 
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			//next_token();
-		}
+void Parser::parse_code(AST* tree) {
+	while (!finished_parsing()) {
+		parse_top_level_item(tree);
+	}
+}
 
-		try { new_node = parse_while_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+// one pass over the top-level rules, it depends only on the tokens from the current one onward
+void Parser::parse_top_level_item(AST* tree) {
+	Token curr = peek();
+	item_diagnostics = diagnostics.size();
 
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			//next_token();
-		}
+	trace.write<TraceCategory::Statements, TraceLevel::Info>(SourceToken{ curr, source, lines }, '\n');
 
-		try { new_node = parse_if_else_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+	if (curr.type == TokenType::NewLine) {
+		next_token();
+		return;
+	}
 
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-		}
+	std::vector<AST*> nodes;
+	size_t before = tokens.consumed();
+	parse_statements(top_level_rules(), nodes);
 
-		try { new_node = parse_return_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
+	tree->add_children(nodes);
 
-		if (new_node != nullptr) {
-			curr = peek();
-			if (curr.type != TokenType::Semicolon) {
-				std::cout << "error on " << curr.line << ' ' << curr.column; exit(-1);
-			}
+	// nothing at the top level starts with this token, a stray } is skipped on its own
+	if (tokens.consumed() == before) {
+		report(Diagnostic{ curr });
 
-			tree->add_children(std::vector<AST*> {new_node});
+		if (!skip_statement()) {
 			next_token();
 		}
-
-		try { new_node = parse_class_definition_expr(); }
-		catch (Token token) { std::cout << "error on " << token.line << ' ' << token.column; exit(-1); }
-
-		if (new_node != nullptr) {
-			tree->add_children(std::vector<AST*> {new_node});
-			//next_token();
-		}
 	}
 }
\ No newline at end of file
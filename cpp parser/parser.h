@@ -1,78 +1,122 @@
 #pragma once
+#include <cstdint>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "token.h"
+#include "token-stream.h"
+#include "token-set.h"
+#include "line-table.h"
 #include "ast-builder.h"
+#include "arena.h"
+#include "parse-result.h"
+#include "trace.h"
+
+class StatementTable;
+
+// the expressions a binary operator can join, bits as one token can join several
+enum class OperatorUse : std::uint8_t {
+	Arithmetic = 1,
+	Relational = 2,
+	Logical = 4,
+	Input = 8,
+	Output = 16,
+	Concatenation = 32
+};
 
 class Parser {
-	std::vector<Token> tokens;
-	unsigned current_token;
+	TokenStream& tokens;
+	std::string_view source;
+	const LineTable& lines;
+	Arena& arena;
+	TraceSink& trace;
+
+	std::vector<Diagnostic> diagnostics;
+	size_t item_diagnostics; // where the ones of the current top-level item start
+
+	void parse_statements(const StatementTable& table, std::vector<AST*>& nodes);
+
+	void report(const Diagnostic& diagnostic);
+	bool skip_statement();
+
+	ParseResult<AST*> parse_binary(OperatorUse use, int min_power, AST* lhs);
+	ParseResult<AST*> parse_operand(OperatorUse use);
+	ParseResult<AST*> parse_arithmetic_operand(bool leading);
+	ParseResult<AST*> parse_logical_operand(bool leading);
+	void trace_root(AST* tree);
 
 public:
 
-	Parser(std::vector<Token> tokens_array);
+	Parser(TokenStream& tokens, std::string_view source, const LineTable& lines, Arena& arena, TraceSink& trace);
+
+	AST* make_ast(std::string_view label);
+	AST* make_ast(Token token);
 
-	bool match_type(Token token,TokenType type);
-	bool match_one_of(Token token, std::vector<TokenType> types);
+	bool match_type(const Token& token, TokenType type);
+	bool match_one_of(const Token& token, const TokenSet& types);
 
 	bool finished_parsing();
 
 	Token peek();
 	Token next_token();
-	Token prev_token();
 
+	// a statement that doesn't parse is left out of the tree and gives a diagnostic, parsing goes on after it
 	void parse_code(AST* tree);
+	void parse_top_level_item(AST* tree);
 
-	AST* parse_include_expr();
-	AST* parse_library_expr();
-	AST* parse_header_expr();
+	// in the order they were found, empty when the whole input parsed
+	const std::vector<Diagnostic>& get_diagnostics() const;
 
-	AST* parse_using_expr();
+	ParseResult<AST*> parse_include_expr();
+	ParseResult<AST*> parse_library_expr();
+	ParseResult<AST*> parse_header_expr();
 
-	AST* parse_decl_assignment_expr();
-	AST* parse_simple_assignment_expr();
-	AST* parse_var_declaration_expr();
+	ParseResult<AST*> parse_using_expr();
 
-	AST* parse_func_definition_expr();
-	std::vector<AST*> parse_func_args_expr();
-	AST* parse_func_call_expr();
+	ParseResult<AST*> parse_decl_assignment_expr();
+	ParseResult<AST*> parse_simple_assignment_expr();
+	ParseResult<AST*> parse_var_declaration_expr();
 
-	AST* parse_arithmetic_expr();
-	AST* build_arithmetic_tree(std::vector<Token> tokens);
+	ParseResult<AST*> parse_func_definition_expr();
+	ParseResult<std::vector<AST*>> parse_func_args_expr();
+	ParseResult<AST*> parse_func_call_expr();
 
-	AST* parse_boolean_expr(std::vector<AST*>& parentheses);
+	ParseResult<AST*> parse_arithmetic_expr();
+
+	ParseResult<AST*> parse_boolean_expr(std::vector<AST*>& parentheses);
 	AST* chain_negations();
 	AST* get_last_node(AST* tree);
 
-	AST* parse_logical_expr();
-	AST* build_logical_tree(std::vector<AST*> trees);
+	ParseResult<AST*> parse_logical_expr();
 
-	AST* parse_string_expr();
-	AST* build_string_tree(std::vector<Token> tokens);
+	ParseResult<AST*> parse_string_expr();
 
-	AST* parse_input_expr();
-	AST* parse_output_expr();
-	AST* build_io_tree(std::vector<AST*> trees);
+	ParseResult<AST*> parse_input_expr();
+	ParseResult<AST*> parse_output_expr();
 
-	AST* parse_for_expr();
-	AST* parse_incr_decr_expr();
+	ParseResult<AST*> parse_for_expr();
+	ParseResult<AST*> parse_incr_decr_expr();
 
-	AST* parse_while_expr();
-	AST* parse_if_else_expr();
-	AST* parse_else_if();
+	ParseResult<AST*> parse_while_expr();
+	ParseResult<AST*> parse_if_else_expr();
+	ParseResult<AST*> parse_else_if();
 
-	AST* parse_return_expr();
+	ParseResult<AST*> parse_return_expr();
 
-	AST* parse_class_definition_expr();
-	AST* parse_class_body();
-	AST* parse_access_specifier_expr();
-	AST* parse_class_constructor_expr();
-	AST* parse_class_destructor_expr();
-	AST* parse_delete_expr();
+	ParseResult<AST*> parse_class_definition_expr();
+	ParseResult<AST*> parse_class_body();
+	ParseResult<AST*> parse_access_specifier_expr();
+	ParseResult<AST*> parse_class_constructor_expr();
+	ParseResult<AST*> parse_class_destructor_expr();
+	ParseResult<AST*> parse_delete_expr();
 
-	AST* parse_line_comment();
-	AST* parse_multiline_comment();
+	ParseResult<AST*> parse_line_comment();
+	ParseResult<AST*> parse_multiline_comment();
 
-	AST* parse_braces_body(const std::string& s);
+	ParseResult<AST*> parse_braces_body(std::string_view str);
 
 };
+
+// an "error on line:column" line for each
+void print_diagnostics(const std::vector<Diagnostic>& diagnostics, const LineTable& lines, std::ostream& out);
@@ -0,0 +1,354 @@
+#include "source-generator.h"
+#include <sstream>
+
+namespace {
+
+	const char* const words[] = { "alpha", "beta", "gamma", "delta", "value", "count", "total", "index" };
+	const char* const arithmetic_ops[] = { " + ", " - ", " * ", " / ", " % ", " ^ " };
+	const char* const comparison_ops[] = { " < ", " > ", " <= ", " >= ", " == ", " != " };
+	const char* const types[] = { "int", "double", "string", "bool", "char" };
+}
+
+bool parse_construct_mix(const std::string& text, ConstructMix& mix) {
+	if (text == "mixed") {
+		mix = ConstructMix();
+		return true;
+	}
+
+	ConstructMix result{ 0, 0, 0, 0, 0, 0, 0 };
+	std::stringstream list(text);
+	std::string entry;
+
+	while (std::getline(list, entry, ',')) {
+		size_t colon = entry.find(':');
+		std::string name = entry.substr(0, colon);
+		unsigned weight = 1;
+
+		if (colon != std::string::npos) {
+			try { weight = std::stoul(entry.substr(colon + 1)); }
+			catch (...) { return false; }
+		}
+
+		if (name == "arithmetic") {
+			result.arithmetic = weight;
+		}
+		else if (name == "nesting") {
+			result.nesting = weight;
+		}
+		else if (name == "classes") {
+			result.classes = weight;
+		}
+		else if (name == "strings") {
+			result.strings = weight;
+		}
+		else if (name == "output") {
+			result.output = weight;
+		}
+		else if (name == "comments") {
+			result.comments = weight;
+		}
+		else if (name == "errors") {
+			result.errors = weight;
+		}
+		else {
+			return false;
+		}
+	}
+
+	if (result.arithmetic + result.nesting + result.classes + result.strings + result.output + result.comments
+		+ result.errors == 0) {
+		return false;
+	}
+
+	mix = result;
+	return true;
+}
+
+SourceGenerator::SourceGenerator(const ConstructMix& mix, unsigned seed, unsigned nesting_depth) : rng(seed) {
+	this->mix = mix;
+	this->nesting_depth = nesting_depth;
+	next_id = 0;
+}
+
+// plain modulo instead of a distribution, those differ between standard libraries
+unsigned SourceGenerator::random(unsigned bound) {
+	return rng() % bound;
+}
+
+std::string SourceGenerator::identifier() {
+	return std::string(words[random(8)]) + std::to_string(random(16));
+}
+
+std::string SourceGenerator::operand() {
+	if (random(2) == 0) {
+		return std::to_string(1 + random(999));
+	}
+
+	return identifier();
+}
+
+std::string SourceGenerator::arithmetic_expr(unsigned depth) {
+	if (depth == 0 || random(4) == 0) {
+		return operand();
+	}
+
+	std::string left = arithmetic_expr(depth - 1);
+	std::string right = arithmetic_expr(depth - 1);
+
+	// the parser can't take a single operand in parentheses, only whole subexpressions get them
+	if (left.find(' ') != std::string::npos && random(3) == 0) {
+		left = "(" + left + ")";
+	}
+
+	return left + arithmetic_ops[random(6)] + right;
+}
+
+std::string SourceGenerator::logical_expr() {
+	std::string result = operand() + comparison_ops[random(6)] + operand();
+
+	for (unsigned i = random(3); i > 0; i--) {
+		result += random(2) == 0 ? " && " : " || ";
+		result += operand() + comparison_ops[random(6)] + operand();
+	}
+
+	return result;
+}
+
+std::string SourceGenerator::string_expr(unsigned parts) {
+	std::string result = "\"" + std::string(words[random(8)]) + "\"";
+
+	for (unsigned i = 1; i < parts; i++) {
+		result += " + ";
+		result += random(2) == 0 ? identifier() : "\"" + std::string(words[random(8)]) + " \"";
+	}
+
+	return result;
+}
+
+void SourceGenerator::indent(std::string& out, unsigned level) {
+	out.append(level * 4, ' ');
+}
+
+void SourceGenerator::add_arithmetic(std::string& out) {
+	std::string result = "r" + std::to_string(next_id);
+
+	out += "int compute" + std::to_string(next_id++) + "() {\n";
+
+	indent(out, 1);
+	out += "int " + result + " = " + arithmetic_expr(5) + ";\n";
+
+	for (unsigned i = 2 + random(4); i > 0; i--) {
+		indent(out, 1);
+		out += result + " = " + arithmetic_expr(5) + ";\n";
+	}
+
+	indent(out, 1);
+	out += "bool ok = " + logical_expr() + ";\n";
+
+	indent(out, 1);
+	out += "return " + result + ";\n";
+	out += "}\n\n";
+}
+
+void SourceGenerator::add_nested_body(std::string& out, unsigned depth, unsigned level) {
+	indent(out, level);
+	out += identifier() + " = " + arithmetic_expr(2) + ";\n";
+
+	if (depth == 0) {
+		return;
+	}
+
+	indent(out, level);
+
+	if (random(2) == 0) {
+		std::string counter = "i" + std::to_string(level);
+
+		out += "for (int " + counter + " = 0; " + counter + " < " + operand() + "; " + counter + "++) {\n";
+		add_nested_body(out, depth - 1, level + 1);
+		indent(out, level);
+		out += "}\n";
+	}
+	else {
+		out += "if (" + logical_expr() + ") {\n";
+		add_nested_body(out, depth - 1, level + 1);
+		indent(out, level);
+		out += "}\n";
+
+		indent(out, level);
+		out += "else {\n";
+		add_nested_body(out, depth / 2, level + 1);
+		indent(out, level);
+		out += "}\n";
+	}
+}
+
+void SourceGenerator::add_nesting(std::string& out) {
+	out += "void nested" + std::to_string(next_id++) + "() {\n";
+	add_nested_body(out, nesting_depth, 1);
+	out += "}\n\n";
+}
+
+void SourceGenerator::add_class(std::string& out) {
+	std::string name = "Type" + std::to_string(next_id++);
+	unsigned field_count = 2 + random(4);
+
+	out += "class " + name + " {\n";
+
+	for (unsigned i = 0; i < field_count; i++) {
+		indent(out, 1);
+		out += std::string(types[i % 5]) + " field" + std::to_string(i) + ";\n";
+	}
+
+	out += "public:\n";
+
+	indent(out, 1);
+	out += name + "(int start, double scale) {\n";
+	indent(out, 2);
+	out += "field0 = start;\n";
+	indent(out, 2);
+	out += "field1 = scale * " + operand() + ";\n";
+	indent(out, 1);
+	out += "}\n";
+
+	for (unsigned i = random(4); i > 0; i--) {
+		indent(out, 1);
+		out += "void method" + std::to_string(i) + "(int amount);\n";
+	}
+
+	indent(out, 1);
+	out += "int get() {\n";
+	indent(out, 2);
+	out += "return field0;\n";
+	indent(out, 1);
+	out += "}\n";
+	out += "}\n\n";
+}
+
+void SourceGenerator::add_strings(std::string& out) {
+	out += "string text" + std::to_string(next_id++) + "() {\n";
+
+	for (unsigned i = 2 + random(3); i > 0; i--) {
+		indent(out, 1);
+		out += "string s" + std::to_string(i) + " = " + string_expr(4 + random(12)) + ";\n";
+	}
+
+	indent(out, 1);
+	out += "return s1;\n";
+	out += "}\n\n";
+}
+
+void SourceGenerator::add_output(std::string& out) {
+	out += "void show" + std::to_string(next_id++) + "() {\n";
+
+	indent(out, 1);
+	out += "cin >> " + identifier() + ";\n";
+
+	for (unsigned i = 2 + random(4); i > 0; i--) {
+		indent(out, 1);
+		out += "cout << \"" + std::string(words[random(8)]) + " = \"";
+
+		for (unsigned j = 1 + random(8); j > 0; j--) {
+			out += " << " + identifier() + " << \", \"";
+		}
+
+		out += " << '\\n';\n";
+	}
+
+	out += "}\n\n";
+}
+
+void SourceGenerator::add_comments(std::string& out) {
+	for (unsigned i = 1 + random(4); i > 0; i--) {
+		out += "//";
+
+		for (unsigned j = 3 + random(10); j > 0; j--) {
+			out += ' ';
+			out += words[random(8)];
+		}
+
+		out += '\n';
+	}
+
+	out += "/*\n";
+
+	for (unsigned i = 2 + random(8); i > 0; i--) {
+		out += " *";
+
+		for (unsigned j = 4 + random(12); j > 0; j--) {
+			out += ' ';
+			out += words[random(8)];
+		}
+
+		out += '\n';
+	}
+
+	out += " */\n\n";
+}
+
+// statements missing a token between ones that parse, each broken one costs the parser a diagnostic
+// and a skip to its ; or past its block
+void SourceGenerator::add_errors(std::string& out) {
+	out += "void broken" + std::to_string(next_id++) + "() {\n";
+
+	for (unsigned i = 4 + random(4); i > 0; i--) {
+		indent(out, 1);
+
+		switch (random(4)) {
+		case 0:
+			out += identifier() + " = " + arithmetic_expr(3) + ";\n";
+			break;
+		case 1:
+			out += identifier() + " = " + arithmetic_expr(3) + arithmetic_ops[random(6)] + ";\n";
+			break;
+		case 2:
+			out += "cout << " + identifier() + " << ;\n";
+			break;
+		default:
+			out += "if (" + logical_expr() + " {\n";
+			indent(out, 2);
+			out += identifier() + " = " + operand() + ";\n";
+			indent(out, 1);
+			out += "}\n";
+			break;
+		}
+	}
+
+	out += "}\n\n";
+}
+
+std::string SourceGenerator::generate(size_t bytes) {
+	unsigned total = mix.arithmetic + mix.nesting + mix.classes + mix.strings + mix.output + mix.comments
+		+ mix.errors;
+	std::string out;
+	out.reserve(bytes + 4096);
+
+	out += "#include <iostream>\nusing namespace std;\n\n";
+
+	while (out.size() < bytes) {
+		unsigned pick = random(total);
+
+		if (pick < mix.arithmetic) {
+			add_arithmetic(out);
+		}
+		else if ((pick -= mix.arithmetic) < mix.nesting) {
+			add_nesting(out);
+		}
+		else if ((pick -= mix.nesting) < mix.classes) {
+			add_class(out);
+		}
+		else if ((pick -= mix.classes) < mix.strings) {
+			add_strings(out);
+		}
+		else if ((pick -= mix.strings) < mix.output) {
+			add_output(out);
+		}
+		else if ((pick -= mix.output) < mix.comments) {
+			add_comments(out);
+		}
+		else {
+			add_errors(out);
+		}
+	}
+
+	return out;
+}
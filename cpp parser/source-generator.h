@@ -0,0 +1,51 @@
+#pragma once
+#include <random>
+#include <string>
+
+// relative weights of the constructs in a generated source, a zero weight leaves the construct out
+struct ConstructMix {
+	unsigned arithmetic = 1; // long arithmetic and boolean expressions
+	unsigned nesting = 1;    // deeply nested if/else and for bodies
+	unsigned classes = 1;    // classes with fields, constructors and methods
+	unsigned strings = 1;    // long string concatenations
+	unsigned output = 1;     // cout and cin chains
+	unsigned comments = 0;   // blocks of // and /* */ comments between functions, not part of the mixed preset
+	unsigned errors = 0;     // functions with statements that don't parse, not part of the mixed preset either
+};
+
+// accepts one of the preset names (mixed, arithmetic, nesting, classes, strings, output, comments, errors)
+// or a list of weights like "arithmetic:3,output:1"
+bool parse_construct_mix(const std::string& text, ConstructMix& mix);
+
+// produces sources in the subset the parser accepts, apart from the errors construct,
+// the same seed gives the same text on every platform
+class SourceGenerator {
+	ConstructMix mix;
+	unsigned nesting_depth;
+	std::mt19937 rng;
+	unsigned next_id;
+
+	unsigned random(unsigned bound);
+	std::string identifier();
+	std::string operand();
+
+	std::string arithmetic_expr(unsigned depth);
+	std::string logical_expr();
+	std::string string_expr(unsigned parts);
+	void indent(std::string& out, unsigned level);
+
+	void add_arithmetic(std::string& out);
+	void add_nesting(std::string& out);
+	void add_nested_body(std::string& out, unsigned depth, unsigned level);
+	void add_class(std::string& out);
+	void add_strings(std::string& out);
+	void add_output(std::string& out);
+	void add_comments(std::string& out);
+	void add_errors(std::string& out);
+
+public:
+
+	SourceGenerator(const ConstructMix& mix, unsigned seed, unsigned nesting_depth = 8);
+
+	std::string generate(size_t bytes);
+};
@@ -0,0 +1,155 @@
+#include "stream-lexer.h"
+#include "char-scan.h"
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+StreamLexer::StreamLexer(std::istream& in, size_t chunk_size, LexerBackend backend) {
+	this->in = &in;
+	descriptor = -1;
+	this->chunk_size = std::max<size_t>(chunk_size, 1);
+	this->backend = backend;
+	keep_comments = true;
+	window_offset = 0;
+	window_position = SourcePosition{ 1, 1 };
+	at_end = false;
+	accepted_end = 0;
+}
+
+StreamLexer::StreamLexer(int descriptor, size_t chunk_size, LexerBackend backend) {
+	in = nullptr;
+	this->descriptor = descriptor;
+	this->chunk_size = std::max<size_t>(chunk_size, 1);
+	this->backend = backend;
+	keep_comments = true;
+	window_offset = 0;
+	window_position = SourcePosition{ 1, 1 };
+	at_end = false;
+	accepted_end = 0;
+}
+
+void StreamLexer::set_keep_comments(bool keep) {
+	keep_comments = keep;
+
+	if (lexer != nullptr) {
+		lexer->set_keep_comments(keep);
+	}
+}
+
+// pipes hand over less than asked for, only 0 means the input ended
+size_t StreamLexer::read_some(char* buffer, size_t size) {
+	size_t got = 0;
+
+	while (got < size) {
+		size_t count = 0;
+
+		if (in != nullptr) {
+			in->read(buffer + got, size - got);
+			count = size_t(in->gcount());
+		}
+		else {
+#ifdef _WIN32
+			int result = _read(descriptor, buffer + got, unsigned(std::min<size_t>(size - got, 1 << 30)));
+#else
+			ssize_t result = read(descriptor, buffer + got, size - got);
+#endif
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+
+			count = result < 0 ? 0 : size_t(result);
+		}
+
+		if (count == 0) {
+			break;
+		}
+
+		got += count;
+	}
+
+	return got;
+}
+
+// drops what the handed out tokens covered and reads at least another chunk after the rest, a token longer
+// than the window doubles it so it is lexed again only a logarithmic number of times
+void StreamLexer::refill() {
+	std::string_view dropped = std::string_view(window).substr(0, accepted_end);
+	size_t newlines = count_newlines(dropped.data(), dropped.data() + dropped.size());
+
+	if (newlines > 0) {
+		window_position.line += std::uint32_t(newlines);
+		window_position.column = std::uint32_t(dropped.size() - dropped.rfind('\n'));
+	}
+	else {
+		window_position.column += std::uint32_t(dropped.size());
+	}
+
+	window.erase(0, accepted_end);
+	window_offset += accepted_end;
+	accepted_end = 0;
+
+	size_t kept = window.size();
+	size_t wanted = std::max(chunk_size, kept);
+
+	window.resize(kept + wanted);
+	window.resize(kept + read_some(window.data() + kept, wanted));
+
+	if (window.size() == kept) {
+		at_end = true;
+	}
+
+	lexer = std::make_unique<Lexer>(window.data(), window.size(), backend);
+	lexer->set_keep_comments(keep_comments);
+}
+
+Token StreamLexer::next() {
+	if (lexer == nullptr) {
+		refill();
+	}
+
+	while (true) {
+		Token token = lexer->next();
+
+		// at the end of the window the lexer also gives EndOfTokens, that one may only mean it needs more
+		if (at_end || (token.type != TokenType::EndOfTokens && lexer->reach() <= window.size())) {
+			if (token.type != TokenType::EndOfTokens) {
+				accepted_end = token.offset + token.length;
+			}
+
+			return token;
+		}
+
+		refill();
+	}
+}
+
+std::string_view StreamLexer::text(const Token& token) const {
+	return std::string_view(window).substr(token.offset, token.length);
+}
+
+SourcePosition StreamLexer::position(const Token& token) const {
+	if (token.type == TokenType::EndOfTokens) {
+		return SourcePosition{ 0, 0 };
+	}
+
+	SourcePosition position = lexer->lines.position(token.offset);
+
+	if (position.line == 1) {
+		return SourcePosition{ window_position.line, window_position.column + position.column - 1 };
+	}
+
+	return SourcePosition{ window_position.line + position.line - 1, position.column };
+}
+
+std::uint64_t StreamLexer::stream_offset(const Token& token) const {
+	return window_offset + token.offset;
+}
+
+size_t StreamLexer::buffered() const {
+	return window.capacity();
+}
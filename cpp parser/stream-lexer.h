@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "lexer.h"
+#include "line-table.h"
+
+// lexes input that arrives in pieces, e.g. through a pipe, without ever holding all of it
+// the input is read chunk_size bytes at a time into a window, a token is only handed out once the lexer
+// says it didn't look past the end of the window, otherwise the window keeps the bytes from the end of
+// the previous token on and more is read, so memory stays around a chunk plus the longest token
+// the tokens are the same Lexer::produce_tokens gives for the whole input, but their offsets are into the window,
+// which the 32 bits of Token::offset always cover, stream_offset gives where one starts in the whole input
+// the regex backend can't tell how far it looked and reads everything first, so does input the lexer
+// can't match since more of it might make it match
+class StreamLexer {
+	std::istream* in;
+	int descriptor;
+	size_t chunk_size;
+	LexerBackend backend;
+	bool keep_comments;
+
+	std::string window;
+	std::uint64_t window_offset; // of window[0] in the whole input
+	SourcePosition window_position;
+	bool at_end;
+
+	std::unique_ptr<Lexer> lexer;
+	size_t accepted_end; // in the window, the next lexer starts here
+
+	size_t read_some(char* buffer, size_t size);
+	void refill();
+
+public:
+
+	StreamLexer(std::istream& in, size_t chunk_size = 1 << 20, LexerBackend backend = LexerBackend::Dfa);
+
+	// reads the descriptor with read(), it isn't closed
+	StreamLexer(int descriptor, size_t chunk_size = 1 << 20, LexerBackend backend = LexerBackend::Dfa);
+
+	StreamLexer(const StreamLexer& other) = delete;
+	StreamLexer& operator=(const StreamLexer& other) = delete;
+
+	void set_keep_comments(bool keep);
+
+	// EndOfTokens once the input is used up
+	Token next();
+
+	// both only for the token next() returned last, until next() is called again
+	std::string_view text(const Token& token) const;
+	SourcePosition position(const Token& token) const;
+	std::uint64_t stream_offset(const Token& token) const;
+
+	// bytes held right now, for checking the bound
+	size_t buffered() const;
+};
@@ -0,0 +1,104 @@
+#include "token-array.h"
+#include <cstring>
+
+static_assert(int(TokenType::EndOfTokens) < 256, "token types have to fit in a byte");
+
+namespace {
+
+	std::uint64_t value_of(const Token& token) {
+		std::uint64_t value;
+		std::memcpy(&value, &token.integer, sizeof(value));
+		return value;
+	}
+
+	Token make_token(std::uint8_t type, TokenSpan span, std::uint64_t value) {
+		Token token(TokenType(type), span.offset, span.length);
+		std::memcpy(&token.integer, &value, sizeof(value));
+		return token;
+	}
+}
+
+TokenType TokenColumns::type(size_t i) const {
+	return TokenType(types[i]);
+}
+
+Token TokenColumns::operator[](size_t i) const {
+	return make_token(types[i], spans[i], values[i]);
+}
+
+TokenArray::TokenArray(TokenColumns columns) {
+	types.assign(columns.types, columns.types + columns.count);
+	spans.assign(columns.spans, columns.spans + columns.count);
+	values.assign(columns.values, columns.values + columns.count);
+}
+
+void TokenArray::push_back(const Token& token) {
+	types.push_back(std::uint8_t(token.type));
+	spans.push_back(TokenSpan{ token.offset, token.length });
+	values.push_back(value_of(token));
+}
+
+void TokenArray::reserve(size_t count) {
+	types.reserve(count);
+	spans.reserve(count);
+	values.reserve(count);
+}
+
+void TokenArray::resize(size_t count) {
+	types.resize(count);
+	spans.resize(count);
+	values.resize(count);
+}
+
+void TokenArray::clear() {
+	types.clear();
+	spans.clear();
+	values.clear();
+}
+
+void TokenArray::set(size_t i, const Token& token) {
+	types[i] = std::uint8_t(token.type);
+	spans[i] = TokenSpan{ token.offset, token.length };
+	values[i] = value_of(token);
+}
+
+void TokenArray::replace(size_t first, size_t last, const TokenArray& with) {
+	types.erase(types.begin() + first, types.begin() + last);
+	types.insert(types.begin() + first, with.types.begin(), with.types.end());
+
+	spans.erase(spans.begin() + first, spans.begin() + last);
+	spans.insert(spans.begin() + first, with.spans.begin(), with.spans.end());
+
+	values.erase(values.begin() + first, values.begin() + last);
+	values.insert(values.begin() + first, with.values.begin(), with.values.end());
+}
+
+void TokenArray::shift_offsets(size_t from, std::int64_t delta) {
+	for (size_t i = from; i < spans.size(); i++) {
+		spans[i].offset = std::uint32_t(spans[i].offset + delta);
+	}
+}
+
+size_t TokenArray::size() const {
+	return types.size();
+}
+
+bool TokenArray::empty() const {
+	return types.empty();
+}
+
+TokenType TokenArray::type(size_t i) const {
+	return TokenType(types[i]);
+}
+
+Token TokenArray::operator[](size_t i) const {
+	return make_token(types[i], spans[i], values[i]);
+}
+
+Token TokenArray::back() const {
+	return (*this)[size() - 1];
+}
+
+TokenColumns TokenArray::columns() const {
+	return TokenColumns{ types.data(), spans.data(), values.data(), types.size() };
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "token.h"
+
+// where a token sits in the source
+struct TokenSpan {
+	std::uint32_t offset;
+	std::uint32_t length;
+};
+
+// read-only view of tokens stored field by field, from a TokenArray or a mapped cache entry laid out the same way
+struct TokenColumns {
+	const std::uint8_t* types;
+	const TokenSpan* spans;
+	const std::uint64_t* values; // Token::integer, or the bits of Token::real
+	size_t count;
+
+	TokenType type(size_t i) const;
+	Token operator[](size_t i) const;
+};
+
+// tokens split into one array per field, the types take a byte each so lookahead that only decides on
+// the type reads a dense array and not whole tokens
+class TokenArray {
+	std::vector<std::uint8_t> types;
+	std::vector<TokenSpan> spans;
+	std::vector<std::uint64_t> values;
+
+public:
+
+	TokenArray() = default;
+	explicit TokenArray(TokenColumns columns);
+
+	void push_back(const Token& token);
+	void reserve(size_t count);
+	void resize(size_t count);
+	void clear();
+
+	// for filling a resized array from several threads, each writes its own indices
+	void set(size_t i, const Token& token);
+
+	// tokens [first, last) give way to the ones of with
+	void replace(size_t first, size_t last, const TokenArray& with);
+
+	void shift_offsets(size_t from, std::int64_t delta);
+
+	size_t size() const;
+	bool empty() const;
+
+	TokenType type(size_t i) const;
+	Token operator[](size_t i) const;
+	Token back() const;
+
+	TokenColumns columns() const;
+};
@@ -0,0 +1,233 @@
+#include "token-cache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace {
+
+	struct EntryHeader {
+		char magic[4];
+		std::uint32_t version;
+		std::uint64_t source_size;
+		std::uint64_t source_hash;
+		std::uint64_t token_count;
+	};
+
+	// the columns follow the header as they are in memory and are used in place, the types are padded
+	// so the spans and values after them stay aligned
+	static_assert(sizeof(EntryHeader) % alignof(std::uint64_t) == 0, "columns after the header must stay aligned");
+
+	const char entry_magic[4] = { 'T', 'O', 'K', 'S' };
+	const char* const entry_extension = ".tok";
+
+	// a word at a time, seeded with the size and the version so either changing gives another entry
+	std::uint64_t hash_source(const char* data, size_t size) {
+		const std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+		std::uint64_t hash = (std::uint64_t(size) << 8 ^ token_cache_version) * multiplier;
+
+		// an empty mapping can have no data at all, memcpy may not be given that pointer even for 0 bytes
+		if (size == 0) {
+			return hash;
+		}
+
+		size_t i = 0;
+
+		for (; i + 8 <= size; i += 8) {
+			std::uint64_t word;
+			std::memcpy(&word, data + i, 8);
+
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 29;
+		}
+
+		std::uint64_t tail = 0;
+		std::memcpy(&tail, data + i, size - i);
+
+		hash = (hash ^ tail) * multiplier;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+
+	size_t padded_types(size_t count) {
+		return (count + 7) / 8 * 8;
+	}
+
+	size_t entry_size(size_t count) {
+		return sizeof(EntryHeader) + padded_types(count) + count * (sizeof(TokenSpan) + sizeof(std::uint64_t));
+	}
+
+	const EntryHeader* header_of(const MappedFile& file) {
+		if (!file.is_open() || file.size() < sizeof(EntryHeader)) {
+			return nullptr;
+		}
+
+		return reinterpret_cast<const EntryHeader*>(file.data());
+	}
+}
+
+CachedTokens::CachedTokens(const std::string& file_name) : file(file_name) {
+}
+
+bool CachedTokens::matches(std::uint64_t hash, size_t source_size) const {
+	const EntryHeader* header = header_of(file);
+
+	return header != nullptr && std::memcmp(header->magic, entry_magic, 4) == 0
+		&& header->version == token_cache_version && header->source_hash == hash && header->source_size == source_size
+		&& header->token_count > 0 && file.size() == entry_size(header->token_count);
+}
+
+TokenColumns CachedTokens::columns() const {
+	size_t count = header_of(file)->token_count;
+	const char* types = file.data() + sizeof(EntryHeader);
+	const char* spans = types + padded_types(count);
+	const char* values = spans + count * sizeof(TokenSpan);
+
+	return TokenColumns{ reinterpret_cast<const std::uint8_t*>(types), reinterpret_cast<const TokenSpan*>(spans),
+		reinterpret_cast<const std::uint64_t*>(values), count };
+}
+
+TokenCache::TokenCache(const std::string& directory, std::uintmax_t max_bytes) {
+	this->directory = directory;
+	this->max_bytes = max_bytes;
+	total_bytes = 0;
+	temporary_count = 0;
+	hits = 0;
+	misses = 0;
+
+	std::error_code error;
+	std::filesystem::create_directories(this->directory, error);
+
+	for (const auto& entry : std::filesystem::directory_iterator(this->directory, error)) {
+		if (entry.path().extension() == entry_extension) {
+			total_bytes += entry.file_size(error);
+		}
+	}
+}
+
+std::filesystem::path TokenCache::entry_path(std::uint64_t hash) const {
+	char name[17];
+	const char* digits = "0123456789abcdef";
+
+	for (int i = 15; i >= 0; i--) {
+		name[i] = digits[hash & 0xf];
+		hash >>= 4;
+	}
+	name[16] = '\0';
+
+	return directory / (std::string(name) + entry_extension);
+}
+
+std::unique_ptr<CachedTokens> TokenCache::find(const char* data, size_t size) {
+	std::uint64_t hash = hash_source(data, size);
+	std::filesystem::path path = entry_path(hash);
+
+	auto entry = std::make_unique<CachedTokens>(path.string());
+
+	if (!entry->matches(hash, size)) {
+		misses++;
+		return nullptr;
+	}
+
+	hits++;
+
+	// the modification time is what eviction goes by, a hit makes the entry the most recently used
+	std::error_code error;
+	std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+	return entry;
+}
+
+void TokenCache::store(const char* data, size_t size, const TokenArray& tokens) {
+	std::uint64_t hash = hash_source(data, size);
+	std::filesystem::path path = entry_path(hash);
+	std::filesystem::path temporary = path;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		temporary += ".tmp" + std::to_string(temporary_count++) + "-" + std::to_string(std::random_device()());
+	}
+
+	EntryHeader header{ {}, token_cache_version, size, hash, tokens.size() };
+	std::memcpy(header.magic, entry_magic, 4);
+
+	{
+		std::ofstream out(temporary, std::ios::binary);
+
+		TokenColumns columns = tokens.columns();
+		const char padding[8] = {};
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(columns.types), columns.count);
+		out.write(padding, padded_types(columns.count) - columns.count);
+		out.write(reinterpret_cast<const char*>(columns.spans), columns.count * sizeof(TokenSpan));
+		out.write(reinterpret_cast<const char*>(columns.values), columns.count * sizeof(std::uint64_t));
+
+		if (!out) {
+			out.close();
+
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+	}
+
+	// readers only ever see a whole entry, another process storing the same one at once is harmless
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	total_bytes += entry_size(tokens.size());
+
+	if (total_bytes > max_bytes) {
+		evict();
+	}
+}
+
+// goes down to three quarters of the limit so the directory isn't listed on every store after it fills up
+void TokenCache::evict() {
+	struct Entry {
+		std::filesystem::file_time_type used;
+		std::filesystem::path path;
+		std::uintmax_t bytes;
+	};
+
+	std::vector<Entry> entries;
+	std::error_code error;
+	total_bytes = 0;
+
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.path().extension() == entry_extension) {
+			entries.push_back(Entry{ entry.last_write_time(error), entry.path(), entry.file_size(error) });
+			total_bytes += entries.back().bytes;
+		}
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.used < b.used;
+	});
+
+	for (const Entry& entry : entries) {
+		if (total_bytes <= max_bytes / 4 * 3) {
+			break;
+		}
+
+		if (std::filesystem::remove(entry.path, error)) {
+			total_bytes -= entry.bytes;
+		}
+	}
+}
+
+std::uint64_t TokenCache::hit_count() const {
+	return hits;
+}
+
+std::uint64_t TokenCache::miss_count() const {
+	return misses;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "token.h"
+#include "token-array.h"
+#include "mapped-file.h"
+
+// bump whenever the lexer can give different tokens for the same bytes, or Token changes layout,
+// entries written by another version are never found again and age out of the cache
+const std::uint32_t token_cache_version = 2;
+
+// the tokens of one cache entry, read straight from the mapped file, the columns of a TokenArray one after the other
+class CachedTokens {
+	MappedFile file;
+
+public:
+
+	CachedTokens(const std::string& file_name);
+
+	// false for a missing, truncated or foreign file
+	bool matches(std::uint64_t hash, size_t source_size) const;
+
+	TokenColumns columns() const;
+};
+
+// tokens of earlier runs on disk, one file per distinct source named after a hash of its bytes,
+// the least recently used entries are deleted once the directory grows past max_bytes
+// safe to share between threads, several processes can use the same directory
+class TokenCache {
+	std::filesystem::path directory;
+	std::uintmax_t max_bytes;
+
+	std::mutex mutex;
+	std::uintmax_t total_bytes;
+	unsigned temporary_count;
+
+	std::atomic<std::uint64_t> hits;
+	std::atomic<std::uint64_t> misses;
+
+	std::filesystem::path entry_path(std::uint64_t hash) const;
+	void evict();
+
+public:
+
+	TokenCache(const std::string& directory, std::uintmax_t max_bytes);
+
+	TokenCache(const TokenCache& other) = delete;
+	TokenCache& operator=(const TokenCache& other) = delete;
+
+	// nullptr on a miss, the source has to be lexed and stored then
+	std::unique_ptr<CachedTokens> find(const char* data, size_t size);
+
+	// tokens must be the whole output of Lexer::produce_tokens for data
+	void store(const char* data, size_t size, const TokenArray& tokens);
+
+	std::uint64_t hit_count() const;
+	std::uint64_t miss_count() const;
+};
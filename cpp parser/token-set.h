@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include "token.h"
+
+// a set of token types as one bit per type, built at compile time and tested with a shift
+class TokenSet {
+	static_assert(size_t(TokenType::EndOfTokens) < 128, "every token type needs a bit");
+
+	std::uint64_t words[2];
+
+public:
+
+	constexpr TokenSet() : words{} {
+	}
+
+	constexpr TokenSet(std::initializer_list<TokenType> types) : words{} {
+		for (TokenType type : types) {
+			words[size_t(type) >> 6] |= std::uint64_t(1) << (size_t(type) & 63);
+		}
+	}
+
+	constexpr bool contains(TokenType type) const {
+		return (words[size_t(type) >> 6] >> (size_t(type) & 63) & 1) != 0;
+	}
+
+	constexpr TokenSet operator|(const TokenSet& other) const {
+		TokenSet result;
+		result.words[0] = words[0] | other.words[0];
+		result.words[1] = words[1] | other.words[1];
+
+		return result;
+	}
+};
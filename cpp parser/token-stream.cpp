@@ -0,0 +1,75 @@
+#include "token-stream.h"
+#include <algorithm>
+
+TokenStream::TokenStream(Lexer& lexer) {
+	this->lexer = &lexer;
+	columns = TokenColumns{ nullptr, nullptr, nullptr, 0 };
+	position = 0;
+	advanced = 0;
+	first = 0;
+
+	for (unsigned i = 0; i < window_size; i++) {
+		window[i] = pull();
+	}
+}
+
+TokenStream::TokenStream(const TokenArray& tokens, size_t start) : TokenStream(tokens.columns(), start) {
+}
+
+TokenStream::TokenStream(TokenColumns columns, size_t start) {
+	lexer = nullptr;
+	this->columns = columns;
+	position = start;
+	advanced = 0;
+	first = 0;
+}
+
+Token TokenStream::pull() {
+	return lexer->next();
+}
+
+// the array ends with EndOfTokens, which is repeated from then on
+Token TokenStream::peek(unsigned distance) const {
+	if (lexer != nullptr) {
+		return window[(first + distance) % window_size];
+	}
+
+	if (columns.count == 0) {
+		return Token(TokenType::EndOfTokens);
+	}
+
+	return columns[std::min(position + distance, columns.count - 1)];
+}
+
+TokenType TokenStream::peek_type(unsigned distance) const {
+	if (lexer != nullptr) {
+		return window[(first + distance) % window_size].type;
+	}
+
+	if (columns.count == 0) {
+		return TokenType::EndOfTokens;
+	}
+
+	return columns.type(std::min(position + distance, columns.count - 1));
+}
+
+// whether the token at the given distance is part of the input rather than padding after its end
+bool TokenStream::available(unsigned distance) const {
+	return distance == 0 || peek_type(distance - 1) != TokenType::EndOfTokens;
+}
+
+void TokenStream::advance() {
+	advanced++;
+
+	if (lexer == nullptr) {
+		position = std::min(position + 1, std::max<size_t>(columns.count, 1) - 1);
+		return;
+	}
+
+	window[first] = pull();
+	first = (first + 1) % window_size;
+}
+
+size_t TokenStream::consumed() const {
+	return advanced;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "token.h"
+#include "token-array.h"
+#include "lexer.h"
+
+// the parser's view of the tokens: the current one plus a fixed window of lookahead,
+// pulled from the lexer on demand or read from an already lexed array
+class TokenStream {
+public:
+	static constexpr unsigned window_size = 3; // the parser looks at most two tokens ahead
+
+private:
+	Lexer* lexer;
+	TokenColumns columns;
+	size_t position;
+	size_t advanced;
+
+	// only used when pulling from the lexer, an array is read in place
+	Token window[window_size];
+	unsigned first;
+
+	Token pull();
+
+public:
+
+	TokenStream(Lexer& lexer);
+	TokenStream(const TokenArray& tokens, size_t start = 0);
+
+	// an array that ends with EndOfTokens and outlives the stream, e.g. one read back from a TokenCache
+	TokenStream(TokenColumns columns, size_t start = 0);
+
+	TokenStream(const TokenStream& other) = delete;
+	TokenStream& operator=(const TokenStream& other) = delete;
+
+	// past the end of the input every peek is EndOfTokens
+	Token peek(unsigned distance = 0) const;
+
+	// reads a byte per token from an array, for decisions that only need the type
+	TokenType peek_type(unsigned distance = 0) const;
+	bool available(unsigned distance) const;
+
+	void advance();
+
+	// how many tokens the parser has moved past since the stream was created
+	size_t consumed() const;
+};
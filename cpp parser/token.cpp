@@ -1,23 +1,19 @@
 #include "token.h"
+#include "line-table.h"
 
-Token::Token(TokenType type, std::string value, unsigned line, unsigned column, unsigned length) {
+Token::Token(TokenType type, std::uint32_t offset, std::uint32_t length) {
 	this->type = type;
-	this->value = value;
-	this->line = line;
-	this->column = column;
+	this->offset = offset;
 	this->length = length;
+	this->integer = 0;
 }
 
-Token::Token(const Token& other) {
-	type = other.type;
-	value = other.value;
-	line = other.line;
-	column = other.column;
-	length = other.length;
+std::string_view Token::value(std::string_view source) const {
+	return source.substr(offset, length);
 }
 
-std::ostream& operator<<(std::ostream& os, const Token& token) {
-	std::string names[]{
+const char* token_type_name(TokenType type) {
+	static const char* const names[]{
 	"LeftParen",
 	"RightParen",
 	"LeftBrace",
@@ -111,7 +107,7 @@ std::ostream& operator<<(std::ostream& os, const Token& token) {
 
 	"NewLine",
 	"LineComment",
-	"MultilineCommentStart",
+	"MultilineComment",
 	"MultilineCommentEnd",
 
 	"AccessSpecifier",
@@ -127,6 +123,12 @@ std::ostream& operator<<(std::ostream& os, const Token& token) {
 	"EndOfTokens"
 	};
 
-	return os  << names[static_cast<int>(token.type)]  << " " << token.value << " "
-		<< token.line << " " << token.column;
+	return names[static_cast<int>(type)];
+}
+
+std::ostream& operator<<(std::ostream& os, const SourceToken& source_token) {
+	const Token& token = source_token.token;
+
+	return os  << token_type_name(token.type)  << " " << token.value(source_token.source) << " "
+		<< position_of(token, source_token.lines);
 }
\ No newline at end of file
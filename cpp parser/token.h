@@ -1,8 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <sstream>
 
-enum class TokenType {
+enum class TokenType : std::uint8_t {
 	LeftParen,
 	RightParen,
 	LeftBrace,
@@ -95,7 +97,7 @@ enum class TokenType {
 
 	NewLine,
 	LineComment,
-	MultilineCommentStart,
+	MultilineComment,
 	MultilineCommentEnd,
 
 	AccessSpecifier,
@@ -111,18 +113,35 @@ enum class TokenType {
 	EndOfTokens
 };
 
+// the text of a token is not stored, only where it sits in the source buffer, a LineTable gives its line and column
 struct Token {
+	std::uint32_t offset;
+	std::uint32_t length;
 	TokenType type;
-	std::string value;
-	unsigned line;
-	unsigned column;
-	unsigned length;
 
-	Token() {};
-	Token(TokenType type, std::string value = "",unsigned line=0,unsigned column = 0,unsigned length = 0);
+	// converted once by the lexer, integer for IntConst and UnsignedConst (two's complement when negative),
+	// real for FloatConst, 0 for every other type
+	union {
+		std::uint64_t integer;
+		double real;
+	};
 
-	Token(const Token& other);
-	
+	Token() = default;
+	Token(TokenType type, std::uint32_t offset = 0, std::uint32_t length = 0);
+
+	std::string_view value(std::string_view source) const;
+};
+
+// the name the token is printed with, e.g. "LeftParen"
+const char* token_type_name(TokenType type);
+
+class LineTable;
+
+// a token paired with the buffer it was lexed from and that buffer's lines, used for printing
+struct SourceToken {
+	const Token& token;
+	std::string_view source;
+	const LineTable& lines;
 };
 
-std::ostream& operator<<(std::ostream& os, const Token& token);
\ No newline at end of file
+std::ostream& operator<<(std::ostream& os, const SourceToken& source_token);
\ No newline at end of file
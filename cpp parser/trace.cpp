@@ -0,0 +1,22 @@
+#include "trace.h"
+
+TraceSink::TraceSink() : out(nullptr), flush_bytes(0) {
+}
+
+TraceSink::TraceSink(std::ostream& out, size_t flush_bytes) : out(&out), flush_bytes(flush_bytes) {
+}
+
+TraceSink::~TraceSink() {
+	flush();
+}
+
+void TraceSink::flush() {
+	if (out == nullptr || buffer.tellp() <= 0) {
+		return;
+	}
+
+	*out << buffer.str();
+	out->flush();
+
+	buffer.str(std::string());
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+
+// what a trace line is about, bits so a build can keep any of them
+enum class TraceCategory : std::uint8_t {
+	Statements = 1,
+	Expressions = 2
+};
+
+// a line is kept when its level is at most the one the program is built with
+enum class TraceLevel : std::uint8_t {
+	Off = 0,
+	Info = 1, // once per statement or block
+	Debug = 2 // once per token or expression node
+};
+
+// chosen when building, TRACE_LEVEL=0 leaves no trace code at all, TRACE_CATEGORIES=1 keeps only the statements
+// without them everything is traced like before
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 2
+#endif
+
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES 3
+#endif
+
+constexpr bool trace_enabled(TraceCategory category, TraceLevel level) {
+	return level != TraceLevel::Off && static_cast<int>(level) <= TRACE_LEVEL
+		&& (static_cast<int>(category) & TRACE_CATEGORIES) != 0;
+}
+
+// where trace lines go, they gather in memory and reach the stream only a block at a time, on flush and at the end
+// so they never come out in the middle of anything else written there
+class TraceSink {
+	std::ostream* out;
+	std::ostringstream buffer;
+	size_t flush_bytes;
+
+public:
+
+	// keeps nothing, the arguments aren't even formatted
+	TraceSink();
+	explicit TraceSink(std::ostream& out, size_t flush_bytes = 64 * 1024);
+	~TraceSink();
+
+	TraceSink(const TraceSink& other) = delete;
+	TraceSink& operator=(const TraceSink& other) = delete;
+
+	// a call for a level or category left out of the build compiles to nothing
+	template <TraceCategory category, TraceLevel level, typename... Args>
+	void write(const Args&... args) {
+		if constexpr (trace_enabled(category, level)) {
+			if (out == nullptr) {
+				return;
+			}
+
+			(buffer << ... << args);
+
+			if (static_cast<size_t>(buffer.tellp()) >= flush_bytes) {
+				flush();
+			}
+		}
+	}
+
+	void flush();
+};
@@ -1,11 +1,33 @@
 #include "utility_funcs.h"
+#include <fstream>
 
 std::string vec_to_str(std::vector<std::string> vec) {
+	size_t total = 0;
+
+	for (size_t i = 0; i < vec.size(); i++) {
+		total += vec[i].size() + 1;
+	}
+
 	std::string s;
+	s.reserve(total);
 
-	for (int i = 0; i < vec.size(); i++) {
-		s += vec[i] + "\n";
+	for (size_t i = 0; i < vec.size(); i++) {
+		s += vec[i];
+		s += '\n';
 	}
 
 	return s;
+}
+
+std::string read_file(const std::string& file_name) {
+	std::ifstream reader(file_name);
+
+	std::string word;
+	std::vector<std::string> file_content;
+
+	while (std::getline(reader, word)) {
+		file_content.push_back(word);
+	}
+
+	return vec_to_str(file_content);
 }
\ No newline at end of file
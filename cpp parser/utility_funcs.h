@@ -2,4 +2,6 @@
 #include <string>
 #include <vector>
 
-std::string vec_to_str(std::vector<std::string> vec);
\ No newline at end of file
+std::string vec_to_str(std::vector<std::string> vec);
+
+std::string read_file(const std::string& file_name);
\ No newline at end of file
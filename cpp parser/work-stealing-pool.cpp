@@ -0,0 +1,78 @@
+#include "work-stealing-pool.h"
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned worker_count) {
+	if (worker_count == 0) {
+		worker_count = 1;
+	}
+
+	for (unsigned i = 0; i < worker_count; i++) {
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	next_queue = 0;
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+	WorkerQueue& queue = *queues[next_queue];
+	next_queue = (next_queue + 1) % queues.size();
+
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	queue.tasks.push_back(std::move(task));
+}
+
+bool WorkStealingPool::pop_own(unsigned worker, std::function<void()>& task) {
+	WorkerQueue& queue = *queues[worker];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.tasks.empty()) {
+		return false;
+	}
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+
+	return true;
+}
+
+bool WorkStealingPool::steal(unsigned worker, std::function<void()>& task) {
+	for (unsigned i = 1; i < queues.size(); i++) {
+		WorkerQueue& victim = *queues[(worker + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// tasks are only submitted before run, so once every queue is empty the worker is done
+void WorkStealingPool::work(unsigned worker) {
+	std::function<void()> task;
+
+	while (pop_own(worker, task) || steal(worker, task)) {
+		task();
+	}
+}
+
+void WorkStealingPool::run() {
+	std::vector<std::thread> threads;
+
+	for (unsigned i = 1; i < queues.size(); i++) {
+		threads.push_back(std::thread(&WorkStealingPool::work, this, i));
+	}
+
+	work(0);
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+unsigned WorkStealingPool::worker_count() const {
+	return queues.size();
+}
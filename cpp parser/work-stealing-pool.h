@@ -0,0 +1,32 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// runs a fixed batch of tasks on several threads, idle workers steal from the front of other queues
+class WorkStealingPool {
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	unsigned next_queue;
+
+	bool pop_own(unsigned worker, std::function<void()>& task);
+	bool steal(unsigned worker, std::function<void()>& task);
+	void work(unsigned worker);
+
+public:
+
+	WorkStealingPool(unsigned worker_count);
+
+	void submit(std::function<void()> task);
+
+	// blocks until every submitted task has finished
+	void run();
+
+	unsigned worker_count() const;
+};